@@ -0,0 +1,68 @@
+/**
+* @file	AmbientOcclusionBuffer.cpp
+* @date	2026-10-19
+* @brief	Reduced resolution render target of the ambient occlusion cones
+*/
+
+#include "AmbientOcclusionBuffer.h"
+
+AmbientOcclusionBuffer::AmbientOcclusionBuffer(int _windowWidth, int _windowHeight, int _scale) :
+	windowWidth{ _windowWidth }, windowHeight{ _windowHeight }, scale{ _scale },
+	width{ (_windowWidth + _scale - 1) / _scale }, height{ (_windowHeight + _scale - 1) / _scale },
+	framebuffer{ 0 }, visibility{ 0 }, surface{ 0 }, depth{ 0 }
+{
+	glCreateTextures(GL_TEXTURE_2D, 1, &visibility);
+	glTextureStorage2D(visibility, 1, GL_R16F, width, height);
+	glCreateTextures(GL_TEXTURE_2D, 1, &surface);
+	glTextureStorage2D(surface, 1, GL_RGBA32F, width, height);
+	glCreateRenderbuffers(1, &depth);
+	glNamedRenderbufferStorage(depth, GL_DEPTH_COMPONENT24, width, height);
+
+	glCreateFramebuffers(1, &framebuffer);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, visibility, 0);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT1, surface, 0);
+	glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glNamedFramebufferDrawBuffers(framebuffer, 2, drawBuffers);
+}
+
+AmbientOcclusionBuffer::~AmbientOcclusionBuffer()
+{
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteTextures(1, &visibility);
+	glDeleteTextures(1, &surface);
+	glDeleteRenderbuffers(1, &depth);
+}
+
+void AmbientOcclusionBuffer::bindForWriting()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, width, height);
+
+	GLfloat clearValue[4] = { 0.f, 0.f, 0.f, 0.f };
+	GLfloat clearDepth = 1.f;
+	for (GLint i = 0; i < 2; ++i)
+		glClearNamedFramebufferfv(framebuffer, GL_COLOR, i, clearValue);
+	glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &clearDepth);
+}
+
+void AmbientOcclusionBuffer::bindImages(GLuint visibilityUnit, GLuint surfaceUnit) const
+{
+	glBindImageTexture(visibilityUnit, visibility, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R16F);
+	glBindImageTexture(surfaceUnit, surface, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+}
+
+int AmbientOcclusionBuffer::getWindowWidth() const
+{
+	return windowWidth;
+}
+
+int AmbientOcclusionBuffer::getWindowHeight() const
+{
+	return windowHeight;
+}
+
+int AmbientOcclusionBuffer::getScale() const
+{
+	return scale;
+}
@@ -0,0 +1,63 @@
+/**
+* @file	AmbientOcclusionBuffer.h
+* @date	2026-10-19
+* @brief	Reduced resolution render target of the ambient occlusion cones
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+/**
+ * @brief Framebuffer holding cone traced ambient visibility at a fraction of the window resolution.
+ *
+ * Attachments: visibility, 1 where nothing occludes (R16F), the surface it was traced from as
+ * world normal and distance to the camera (RGBA32F, 0 where nothing was hit) and depth. The full
+ * resolution pass upsamples the visibility guided by the surface attachment.
+ */
+class AmbientOcclusionBuffer
+{
+public:
+	AmbientOcclusionBuffer() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param windowWidth Width of the window in pixels.
+	 * @param windowHeight Height of the window in pixels.
+	 * @param scale Window pixels per buffer pixel along each axis.
+	 */
+	AmbientOcclusionBuffer(int windowWidth, int windowHeight, int scale);
+
+	~AmbientOcclusionBuffer();
+
+	AmbientOcclusionBuffer(const AmbientOcclusionBuffer&) = delete;
+	AmbientOcclusionBuffer& operator=(const AmbientOcclusionBuffer&) = delete;
+
+	/**
+	 * @brief Binds the framebuffer, sets the viewport to its size and clears all attachments.
+	 */
+	void bindForWriting();
+
+	/**
+	 * @brief Binds visibility and surface as read only images.
+	 * @param visibilityUnit Image unit of the visibility attachment.
+	 * @param surfaceUnit Image unit of the surface attachment.
+	 */
+	void bindImages(GLuint visibilityUnit, GLuint surfaceUnit) const;
+
+	int getWindowWidth() const;
+	int getWindowHeight() const;
+	int getScale() const;
+
+private:
+	int windowWidth;
+	int windowHeight;
+	int scale;
+	int width;
+	int height;
+	GLuint framebuffer;
+	GLuint visibility;
+	GLuint surface;
+	GLuint depth;
+};
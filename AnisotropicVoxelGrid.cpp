@@ -0,0 +1,138 @@
+/**
+* @file	AnisotropicVoxelGrid.cpp
+* @date	2026-10-19
+* @brief	Directional mip chain for a voxel grid
+*/
+
+#include "AnisotropicVoxelGrid.h"
+
+#include <string>
+
+AnisotropicVoxelGrid::AnisotropicVoxelGrid(glm::ivec3 baseSize, VOXEL_FORMAT format) :
+	size{ glm::max(baseSize / 2, glm::ivec3(1)) },
+	separateOpacity{ hasSeparateVoxelOpacity(format) },
+	volumes{},
+	opacityVolumes{},
+	baseShader{ "resc/shaders/anisoMipmapBaseComp.shader" },
+	mipShader{ "resc/shaders/anisoMipmapVolumeComp.shader" },
+	baseOpacityShader{ "resc/shaders/anisoMipmapBaseComp.shader" },
+	mipOpacityShader{ "resc/shaders/anisoMipmapVolumeComp.shader" }
+{
+	for (auto& volume : volumes)
+		volume = new Texture3D(size.x, size.y, size.z, getVoxelInternalFormat(format));
+
+	addVoxelFormatDefines(baseShader, format);
+	addVoxelFormatDefines(mipShader, format);
+	baseShader.compile();
+	baseShader.link();
+	mipShader.compile();
+	mipShader.link();
+
+	if (separateOpacity)
+	{
+		for (auto& volume : opacityVolumes)
+			volume = new Texture3D(size.x, size.y, size.z, GL_R8);
+
+		// Same reduction, writing only the blended opacity
+		for (ShaderProgram* shader : { &baseOpacityShader, &mipOpacityShader })
+		{
+			addVoxelFormatDefines(*shader, format);
+			shader->addDefine("VOXEL_OPACITY_PASS");
+			shader->compile();
+			shader->link();
+		}
+	}
+}
+
+AnisotropicVoxelGrid::~AnisotropicVoxelGrid()
+{
+	for (auto volume : volumes)
+		delete volume;
+	for (auto volume : opacityVolumes)
+		delete volume;
+}
+
+void AnisotropicVoxelGrid::build(const Texture3D& base, const Texture3D* opacity)
+{
+	build(base, opacity, glm::ivec3(0), glm::ivec3(base.getWidth(), base.getHeight(), base.getDepth()));
+}
+
+void AnisotropicVoxelGrid::build(const Texture3D& base, const Texture3D* opacity, glm::ivec3 regionMin, glm::ivec3 regionMax)
+{
+	const int passes = separateOpacity ? 2 : 1;
+
+	for (int level = 0; level < volumes[0]->getLevels(); ++level)
+	{
+		// Region of this level touched by the source region, rounded outwards. Level n matches source level n + 1.
+		const int shift = level + 1;
+		const glm::ivec3 levelMin = regionMin >> shift;
+		const glm::ivec3 levelMax = (regionMax + glm::ivec3((1 << shift) - 1)) >> shift;
+		const glm::ivec3 levelSize = levelMax - levelMin;
+		if (levelSize.x <= 0 || levelSize.y <= 0 || levelSize.z <= 0)
+			break;
+
+		if (level > 0)
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		// Colour first, then opacity, both reading the previous level of colour and opacity
+		for (int pass = 0; pass < passes; ++pass)
+		{
+			ShaderProgram& shader = pass == 0 ? (level == 0 ? baseShader : mipShader) : (level == 0 ? baseOpacityShader : mipOpacityShader);
+			shader.use();
+
+			if (level == 0)
+			{
+				// Level 0 is reduced from 2x2x2 blocks of the source grid
+				base.bind(0);
+				shader.uploadUniform("voxGrid", 0);
+				if (opacity != nullptr)
+				{
+					opacity->bind(1);
+					shader.uploadUniform("voxOpacity", 1);
+				}
+			}
+			else
+			{
+				// The remaining levels are reduced from the previous level of the same direction
+				for (GLuint i = 0; i < volumes.size(); ++i)
+				{
+					volumes[i]->bind(i);
+					shader.uploadUniform("voxAniso[" + std::to_string(i) + "]", static_cast<int>(i));
+					if (separateOpacity)
+					{
+						opacityVolumes[i]->bind(6 + i);
+						shader.uploadUniform("voxAnisoOpacity[" + std::to_string(i) + "]", static_cast<int>(6 + i));
+					}
+				}
+				shader.uploadUniform("sourceLevel", level - 1);
+			}
+
+			const std::array<Texture3D*, 6>& targets = pass == 0 ? volumes : opacityVolumes;
+			for (GLuint i = 0; i < targets.size(); ++i)
+				glBindImageTexture(i, targets[i]->textureID, level, GL_TRUE, 0, GL_WRITE_ONLY, targets[i]->getFormat());
+			shader.uploadUniform("regionOffset", levelMin);
+			shader.uploadUniform("regionSize", levelSize);
+
+			shader.dispatch((levelSize.x + 3) / 4, (levelSize.y + 3) / 4, (levelSize.z + 3) / 4);
+		}
+	}
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void AnisotropicVoxelGrid::bind(GLuint firstTexUnit) const
+{
+	for (GLuint i = 0; i < volumes.size(); ++i)
+		volumes[i]->bind(firstTexUnit + i);
+}
+
+void AnisotropicVoxelGrid::bindOpacity(GLuint firstTexUnit) const
+{
+	for (GLuint i = 0; i < opacityVolumes.size(); ++i)
+		opacityVolumes[i]->bind(firstTexUnit + i);
+}
+
+glm::ivec3 AnisotropicVoxelGrid::getSize() const
+{
+	return size;
+}
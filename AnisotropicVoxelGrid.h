@@ -0,0 +1,83 @@
+/**
+* @file	AnisotropicVoxelGrid.h
+* @date	2026-10-19
+* @brief	Directional mip chain for a voxel grid
+*/
+
+#pragma once
+
+#include <array>
+
+#include "Texture3D.h"
+#include "ShaderProgram.h"
+#include "VoxelFormat.h"
+
+/**
+ * @brief Six directional mip volumes (+X, -X, +Y, -Y, +Z, -Z) built from a voxel grid.
+ *
+ * Each volume stores the voxel grid at half resolution and below, where every
+ * level is built by front to back alpha blending along its own axis instead of
+ * averaging opacity isotropically. Level n of a volume corresponds to level n + 1
+ * of the source grid. For formats without alpha, opacity is kept in six R8
+ * volumes alongside, built in a second pass per level.
+ */
+class AnisotropicVoxelGrid
+{
+public:
+	AnisotropicVoxelGrid() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param baseSize Dimensions of the source voxel grid. The directional volumes are half this size.
+	 * @param format Format of the source grid and the directional volumes.
+	 */
+	explicit AnisotropicVoxelGrid(glm::ivec3 baseSize, VOXEL_FORMAT format = VOXEL_FORMAT::RGBA8);
+
+	~AnisotropicVoxelGrid();
+
+	AnisotropicVoxelGrid(const AnisotropicVoxelGrid&) = delete;
+	AnisotropicVoxelGrid& operator=(const AnisotropicVoxelGrid&) = delete;
+
+	/**
+	 * @brief Rebuilds all directional volumes from level 0 of the given grid.
+	 * @param base Source voxel grid. Expected to be twice the size of the directional volumes.
+	 * @param opacity Opacity of the source grid, required for formats without alpha.
+	 */
+	void build(const Texture3D& base, const Texture3D* opacity);
+
+	/**
+	 * @brief Rebuilds the parts of all directional volumes covering a region of level 0 of the given grid.
+	 * @param base Source voxel grid.
+	 * @param opacity Opacity of the source grid, required for formats without alpha.
+	 * @param regionMin First voxel of the changed region of the source grid.
+	 * @param regionMax One past the last voxel of the changed region of the source grid.
+	 */
+	void build(const Texture3D& base, const Texture3D* opacity, glm::ivec3 regionMin, glm::ivec3 regionMax);
+
+	/**
+	 * @brief Binds the six volumes to consecutive texture units.
+	 * @param firstTexUnit Unit of the +X volume, the others follow in +X, -X, +Y, -Y, +Z, -Z order.
+	 */
+	void bind(GLuint firstTexUnit) const;
+
+	/**
+	 * @brief Binds the six opacity volumes to consecutive texture units. Only valid for formats without alpha.
+	 * @param firstTexUnit Unit of the +X volume, the others follow in +X, -X, +Y, -Y, +Z, -Z order.
+	 */
+	void bindOpacity(GLuint firstTexUnit) const;
+
+	/**
+	 * @brief Dimensions of level 0 of the directional volumes.
+	 */
+	glm::ivec3 getSize() const;
+
+private:
+	glm::ivec3 size;
+	bool separateOpacity;
+	std::array<Texture3D*, 6> volumes;
+	std::array<Texture3D*, 6> opacityVolumes;
+	ShaderProgram baseShader;
+	ShaderProgram mipShader;
+	ShaderProgram baseOpacityShader;
+	ShaderProgram mipOpacityShader;
+};
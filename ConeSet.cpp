@@ -0,0 +1,194 @@
+/**
+* @file	ConeSet.cpp
+* @date	2026-10-19
+* @brief	Diffuse cone directions and precomputed marching schedules of the cone tracer
+*/
+
+#include "ConeSet.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Samples per schedule at most, far more than a cone takes through a 512^3 volume
+	const int MAX_SCHEDULE = 4096;
+
+	// Highest mip level the cones sample
+	const float MAX_LOD = 6.f;
+
+	// std140 layout of the ConeSet uniform block
+	struct ConeSetBlock
+	{
+		glm::vec4 directions[ConeSet::MAX_CONES];
+		GLint coneCount;
+		GLfloat aperture;
+		GLint diffuseSchedule;
+		GLint diffuseScheduleLength;
+		GLint specularSchedule;
+		GLint specularScheduleLength;
+		GLint shadowSchedule;
+		GLint shadowScheduleLength;
+	};
+	static_assert(sizeof(ConeSetBlock) == 288, "ConeSetBlock must match the std140 layout of the uniform block");
+
+	// Cones on a ring at polar angle theta from the normal, the first at azimuth phase
+	void addRing(std::vector<glm::vec4>& cones, int count, float theta, float phase)
+	{
+		const float pi = 3.14159265f;
+		for (int i = 0; i < count; ++i)
+		{
+			const float phi = phase + 2.f * pi * i / count;
+			cones.emplace_back(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta), std::cos(theta));
+		}
+	}
+
+	// Appends samples from start until maxDistance, lodOf giving the mip level and stepOf the step at a distance
+	template <typename Lod, typename Step>
+	int addSchedule(std::vector<glm::vec4>& schedule, float start, float maxDistance, Lod lodOf, Step stepOf)
+	{
+		const int first = (int)schedule.size();
+		for (float dist = start; dist < maxDistance && (int)schedule.size() - first < MAX_SCHEDULE; )
+		{
+			const float lod = lodOf(dist);
+			const float step = std::max(stepOf(lod), 1e-4f);
+			schedule.emplace_back(dist, lod, step, 0.f);
+			dist += step;
+		}
+		return (int)schedule.size() - first;
+	}
+}
+
+const int ConeSet::TIERS[5] = { 3, 5, 6, 9, 16 };
+const int ConeSet::MAX_CONES;
+
+ConeSet::ConeSet() :
+	coneCount{ 0 }, voxelWorldSize{ 0.f }, volumeExtent{ 0.f }, lengths{ 0 }, uniformBuffer{ 0 }, scheduleBuffer{ 0 }
+{
+	glCreateBuffers(1, &uniformBuffer);
+	glNamedBufferStorage(uniformBuffer, sizeof(ConeSetBlock), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glCreateBuffers(1, &scheduleBuffer);
+}
+
+ConeSet::~ConeSet()
+{
+	glDeleteBuffers(1, &uniformBuffer);
+	glDeleteBuffers(1, &scheduleBuffer);
+}
+
+void ConeSet::update(int _coneCount, GLfloat _voxelWorldSize, glm::vec3 _volumeExtent)
+{
+	if (_coneCount == coneCount && _voxelWorldSize == voxelWorldSize && _volumeExtent == volumeExtent)
+		return;
+	coneCount = _coneCount;
+	voxelWorldSize = _voxelWorldSize;
+	volumeExtent = _volumeExtent;
+
+	// The same step rules the marching loops used, voxelSize being half a voxel
+	const float voxelSize = 0.5f * voxelWorldSize;
+	const float maxDistance = glm::length(volumeExtent);
+	const float aperture = getAperture(coneCount);
+	std::vector<glm::vec4> schedule;
+
+	ConeSetBlock block{};
+	block.diffuseSchedule = (GLint)schedule.size();
+	block.diffuseScheduleLength = addSchedule(schedule, 0.05f, maxDistance,
+		[&](float dist) { return std::log2(1.f + aperture * dist / voxelSize); },
+		[&](float lod) { return lod * voxelSize * 3.f; });
+	for (int i = block.diffuseSchedule; i < (int)schedule.size(); ++i)
+		schedule[i].y = std::min(schedule[i].y, MAX_LOD);
+
+	block.specularSchedule = (GLint)schedule.size();
+	block.specularScheduleLength = addSchedule(schedule, 2.f * voxelSize, maxDistance,
+		[&](float dist) { return 0.1f * std::log2(1.f + dist / voxelSize); },
+		[&](float lod) { return voxelSize * (1.f + 0.15f * lod); });
+	for (int i = block.specularSchedule; i < (int)schedule.size(); ++i)
+		schedule[i].y = std::min(schedule[i].y, MAX_LOD);
+
+	// Shadow cones sample two levels derived from this one
+	block.shadowSchedule = (GLint)schedule.size();
+	block.shadowScheduleLength = addSchedule(schedule, 2.f * voxelSize, maxDistance,
+		[&](float dist) { return 0.6f * std::log2(1.f + dist / voxelSize); },
+		[&](float lod) { return voxelSize * (1.f + 0.15f * lod) / 2.f; });
+
+	const std::vector<glm::vec4> directions = getDirections(coneCount);
+	std::copy(directions.begin(), directions.end(), block.directions);
+	block.coneCount = (GLint)directions.size();
+	block.aperture = aperture;
+
+	glNamedBufferSubData(uniformBuffer, 0, sizeof(ConeSetBlock), &block);
+	glNamedBufferData(scheduleBuffer, schedule.size() * sizeof(glm::vec4), schedule.data(), GL_STATIC_DRAW);
+	lengths = glm::ivec3(block.diffuseScheduleLength, block.specularScheduleLength, block.shadowScheduleLength);
+}
+
+void ConeSet::bind(GLuint uniformBinding, GLuint storageBinding) const
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, uniformBinding, uniformBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, storageBinding, scheduleBuffer);
+}
+
+glm::ivec3 ConeSet::getScheduleLengths() const
+{
+	return lengths;
+}
+
+std::vector<glm::vec4> ConeSet::getDirections(int coneCount)
+{
+	const float degrees = 3.14159265f / 180.f;
+	std::vector<glm::vec4> cones{ glm::vec4(0.f, 0.f, 1.f, 1.f) };
+
+	// The three and five cone sets keep the tuned weights of the original five cones: the front
+	// cone and side cones along the surface, the three cone set has one pair standing in for both
+	if (coneCount == 3)
+	{
+		cones.emplace_back(1.f, 0.f, 0.f, 2.f);
+		cones.emplace_back(-1.f, 0.f, 0.f, 2.f);
+		return cones;
+	}
+	if (coneCount == 5)
+	{
+		cones.emplace_back(1.f, 0.f, 0.f, 1.f);
+		cones.emplace_back(-1.f, 0.f, 0.f, 1.f);
+		cones.emplace_back(0.f, 1.f, 0.f, 1.f);
+		cones.emplace_back(0.f, -1.f, 0.f, 1.f);
+		return cones;
+	}
+
+	// Larger sets cover the hemisphere in rings, cosine weighted and scaled to the total weight of five
+	if (coneCount == 6)
+	{
+		addRing(cones, 5, 60.f * degrees, 0.f);
+	}
+	else if (coneCount == 9)
+	{
+		addRing(cones, 4, 45.f * degrees, 0.f);
+		addRing(cones, 4, 80.f * degrees, 45.f * degrees);
+	}
+	else
+	{
+		addRing(cones, 5, 35.f * degrees, 0.f);
+		addRing(cones, 10, 70.f * degrees, 18.f * degrees);
+	}
+
+	float weightSum = 0.f;
+	for (const glm::vec4& cone : cones)
+		weightSum += cone.w;
+	for (glm::vec4& cone : cones)
+		cone.w *= 5.f / weightSum;
+	return cones;
+}
+
+GLfloat ConeSet::getAperture(int coneCount)
+{
+	switch (coneCount)
+	{
+	case 6:
+		return 0.3f;
+	case 9:
+		return 0.25f;
+	case 16:
+		return 0.18f;
+	default:
+		return 0.35f;
+	}
+}
@@ -0,0 +1,77 @@
+/**
+* @file	ConeSet.h
+* @date	2026-10-19
+* @brief	Diffuse cone directions and precomputed marching schedules of the cone tracer
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief Cone configuration of the cone tracing shaders, in a uniform buffer and a schedule buffer.
+ *
+ * The uniform buffer holds the diffuse cones of a quality tier in tangent space (z along the
+ * normal, weight in w), their aperture and where each schedule starts. The schedules list every
+ * sample of a cone as distance, mip level and step to the next sample, for the diffuse, specular
+ * and shadow cones, so the marching loops fetch them instead of evaluating log2 per step.
+ * They depend on the voxel size and the aperture only and are rebuilt when either changes.
+ */
+class ConeSet
+{
+public:
+	// Diffuse cone counts of the quality tiers
+	static const int TIERS[5];
+	static const int MAX_CONES = 16;
+
+	ConeSet();
+	~ConeSet();
+
+	ConeSet(const ConeSet&) = delete;
+	ConeSet& operator=(const ConeSet&) = delete;
+
+	/**
+	 * @brief Selects a tier and rebuilds the buffers if it or the volume changed.
+	 * @param coneCount Diffuse cone count, one of TIERS.
+	 * @param voxelWorldSize Edge length of a voxel in world space.
+	 * @param volumeExtent Size of the voxel volume in world space.
+	 */
+	void update(int coneCount, GLfloat voxelWorldSize, glm::vec3 volumeExtent);
+
+	/**
+	 * @brief Binds the uniform and the schedule buffer.
+	 * @param uniformBinding Uniform buffer binding of the cone set.
+	 * @param storageBinding Shader storage binding of the schedules.
+	 */
+	void bind(GLuint uniformBinding, GLuint storageBinding) const;
+
+	/**
+	 * @brief Gets the samples per cone at most, of the diffuse, specular and shadow schedule.
+	 */
+	glm::ivec3 getScheduleLengths() const;
+
+	/**
+	 * @brief Gets the diffuse cones of a tier, tangent space direction with weight in w.
+	 * @param coneCount One of TIERS.
+	 */
+	static std::vector<glm::vec4> getDirections(int coneCount);
+
+	/**
+	 * @brief Gets how much the diameter of the diffuse cones of a tier grows per distance travelled.
+	 * @param coneCount One of TIERS.
+	 */
+	static GLfloat getAperture(int coneCount);
+
+private:
+	int coneCount;
+	GLfloat voxelWorldSize;
+	glm::vec3 volumeExtent;
+	glm::ivec3 lengths;
+	GLuint uniformBuffer;
+	GLuint scheduleBuffer;
+};
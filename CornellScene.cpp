@@ -6,10 +6,36 @@
 */
 
 #include "CornellScene.h"
+#include "Utils.h"
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
 
+namespace
+{
+	// Orbit of the emissive ball around the top of the scene
+	void placeBall(SceneObject& ball, GLfloat time)
+	{
+		ball.setChain(glm::vec3(20.f * sin(time), 20.f, 20.f * cos(time)), 0.f, glm::vec3(1.f), 0.025f * glm::vec3(1.f));
+	}
+}
 
-CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128}, voxelGrid{nullptr}, cycleMode{0}
+
+CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128}, voxelGridDims{128}, fitVoxelAspect{false},
+	worldToVoxel{1.f}, voxelToWorld{1.f}, voxelWorldSize{0.f}, voxelFormat{VOXEL_FORMAT::R11G11B10F}, radianceBuffers{}, giLatency{0}, writeBuffer{0}, readBuffer{0}, latestBuffer{0},
+	voxelAlbedo{nullptr}, voxelNormal{nullptr}, voxelEmissive{nullptr}, voxelAmbient{nullptr}, voxelBounce{nullptr}, bounceDivisor{0}, bouncePhase{0}, geometryDirty{true}, voxelizedTransforms{}, voxelScheduler{nullptr}, distanceField{nullptr}, occupancyPyramid{nullptr}, occupancyUnit{-1}, emptySpaceSkipping{EMPTY_SPACE_SKIPPING::DISTANCE_FIELD}, sparseScene{false}, cornellBox{nullptr}, coneStepBuffer{0}, countConeSteps{false}, maxConeSteps{1024}, voxelUpdateDivisor{1}, voxelCacheChecked{false}, anisotropicVoxels{true}, atomicVoxelization{true}, droppedWriteBuffer{0},
+	voxelizationPath{VOXELIZATION_PATH::GEOMETRY_SHADER}, hardwareConservativeRaster{false}, shaderDilation{false},
+	triangleVoxelizer{nullptr}, hybridVoxelization{false}, shadowMap{nullptr}, shadowMapInjection{false},
+	gBuffer{nullptr}, deferredShading{false}, materialBuffer{0}, fullscreenVao{0}, fragmentQuery{0}, fragmentQueryPending{false}, fragmentQueryDeferred{false},
+	depthPrepass{false}, overdrawQueries{0, 0}, overdrawQueryPending{false},
+	diffuseBuffer{nullptr}, occlusionBuffer{nullptr}, ambientOcclusion{true}, occlusionScale{2}, diffuseScale{1}, measureDiffuse{false}, temporalAccumulator{nullptr}, temporalDiffuse{false},
+	coneTracingPrograms{nullptr}, indirectDiffusePrograms{nullptr}, ambientOcclusionPrograms{nullptr}, deferredConeTracingPrograms{nullptr},
+	specularCones{true}, shadowCones{true}, coneSet{nullptr}, diffuseCones{5}, stepHeatmap{nullptr}, heatmapView{-1},
+	mipmapper{nullptr}, computeMipmaps{true}, profiler{}, printTimings{false}, lastTimingReport{0.f}, cycleMode{0}
 {
 	windowPtr = window;
 	windowPtr->setCursorMode(CursorMode::DISABLED);
@@ -19,12 +45,26 @@ CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128},
 	// openGL setup
 	glClearColor(0.f, 0.f, 0.f, 1.0f);
 	glActiveTexture(GL_TEXTURE0);
-	glEnable(GL_CONSERVATIVE_RASTERIZATION_NV);
+
+	// Without conservative rasterization in hardware the voxelization shaders dilate triangles
+	hardwareConservativeRaster = GLEW_NV_conservative_raster != 0;
+	shaderDilation = !hardwareConservativeRaster;
+	if (hardwareConservativeRaster)
+		glEnable(GL_CONSERVATIVE_RASTERIZATION_NV);
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
 
+	// Cone tracing fills texture units 0-15 with a separate opacity volume, 0-7 and 15 without.
+	// The occupancy pyramid takes unit 8 or a 17th unit, without one its skipping mode is left out
+	GLint textureUnits = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &textureUnits);
+	if (!hasSeparateVoxelOpacity(voxelFormat))
+		occupancyUnit = 8;
+	else if (textureUnits > 16)
+		occupancyUnit = 16;
+
 	// Set render wireframe mode
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
@@ -60,6 +100,7 @@ CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128},
 		box->mat.setSpecularReflectivity(0.1f);
 		box->setTexture("Cornell");
 		sceneObjs.emplace("Box", box);
+		cornellBox = box;
 
 		SceneObject* bunny = new SceneObject{ "resc/bunnyHD.obj" };
 		bunny->translate(glm::vec3(0.36f, 0.0f, -0.38f));
@@ -95,12 +136,60 @@ CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128},
 		ball->mat.setShininess(0.6f*128.f);
 		ball->mat.setEmissivity(1.f);
 		ball->setTexture("Cornell");
+		ball->setDynamic(true);
+
+		// The orbit is a circle about y, the positions a quarter turn apart span the box it sweeps
+		glm::vec3 orbitMin(std::numeric_limits<float>::max());
+		glm::vec3 orbitMax(-std::numeric_limits<float>::max());
+		for (int quarter = 0; quarter < 4; ++quarter)
+		{
+			glm::vec3 boundsMin, boundsMax;
+			placeBall(*ball, 0.5f * glm::pi<float>() * quarter);
+			ball->getWorldBounds(boundsMin, boundsMax);
+			orbitMin = glm::min(orbitMin, boundsMin);
+			orbitMax = glm::max(orbitMax, boundsMax);
+		}
+		ball->setMotionBounds(orbitMin, orbitMax);
 		sceneObjs.emplace("Ball", ball);
 
 	}
 
-	// Shader init
-	ShaderProgram* shaderProgram = new ShaderProgram{ "resc/shaders/coneTracingVert.shader", "resc/shaders/coneTracingFrag.shader" };
+	// Shader init. Cone tracing is compiled per feature set on first use, see getConeTracingFeatures
+	coneTracingPrograms = new ShaderPermutationCache("coneTracing", [this]() {
+		ShaderProgram* program = new ShaderProgram{ "resc/shaders/coneTracingVert.shader", "resc/shaders/coneTracingFrag.shader" };
+		addVoxelFormatDefines(*program, voxelFormat);
+		return program;
+	});
+	indirectDiffusePrograms = new ShaderPermutationCache("indirectDiffuse", [this]() {
+		ShaderProgram* program = new ShaderProgram{ "resc/shaders/coneTracingVert.shader", "resc/shaders/coneTracingFrag.shader" };
+		addVoxelFormatDefines(*program, voxelFormat);
+		program->addDefine("INDIRECT_DIFFUSE_PASS");
+		return program;
+	});
+	ambientOcclusionPrograms = new ShaderPermutationCache("ambientOcclusion", [this]() {
+		ShaderProgram* program = new ShaderProgram{ "resc/shaders/coneTracingVert.shader", "resc/shaders/coneTracingFrag.shader" };
+		addVoxelFormatDefines(*program, voxelFormat);
+		program->addDefine("AMBIENT_OCCLUSION_PASS");
+		return program;
+	});
+	deferredConeTracingPrograms = new ShaderPermutationCache("deferredConeTracing", [this]() {
+		ShaderProgram* program = new ShaderProgram{ "resc/shaders/fullscreenVert.shader", "resc/shaders/coneTracingFrag.shader" };
+		addVoxelFormatDefines(*program, voxelFormat);
+		program->addDefine("DEFERRED");
+		return program;
+	});
+	try
+	{
+		coneTracingPrograms->get(getConeTracingFeatures());
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
+
+	// Deferred path: the G-buffer pass shares the forward vertex shader, cone tracing runs once per pixel
+	ShaderProgram* shaderProgram = new ShaderProgram{ "resc/shaders/coneTracingVert.shader", "resc/shaders/gbufferFrag.shader" };
 	try
 	{
 		shaderProgram->compile();
@@ -114,8 +203,24 @@ CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128},
 		std::cerr << ex.what() << std::endl;
 		glfwTerminate();
 	}
-	shaders.emplace("ConeTracing" , shaderProgram);
-	
+	shaders.emplace("GBuffer", shaderProgram);
+
+	shaderProgram = new ShaderProgram{ "resc/shaders/coneTracingVert.shader", "resc/shaders/depthOnlyFrag.shader" };
+	try
+	{
+		shaderProgram->compile();
+		shaderProgram->bindAttribLocation(0, "vertex_position");
+		shaderProgram->bindAttribLocation(1, "vertex_normal");
+		shaderProgram->bindAttribLocation(2, "vertex_texture_coordinates");
+		shaderProgram->link();
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
+	shaders.emplace("DepthOnly", shaderProgram);
+
 	shaderProgram = new ShaderProgram{ "resc/shaders/voxelizationVert.shader", "resc/shaders/voxelizationFrag.shader", "resc/shaders/voxelizationGeom.shader" };
 	try
 	{
@@ -131,14 +236,109 @@ CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128},
 		glfwTerminate();
 	}
 	shaders.emplace("Voxelization", shaderProgram);
+
+	if (GLEW_ARB_shader_viewport_layer_array)
+	{
+		shaderProgram = new ShaderProgram{ "resc/shaders/voxelizationPullVert.shader", "resc/shaders/voxelizationFrag.shader" };
+		try
+		{
+			shaderProgram->compile();
+			shaderProgram->link();
+		}
+		catch (const ShaderProgramException& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			glfwTerminate();
+		}
+		shaders.emplace("VoxelizationPulled", shaderProgram);
+	}
+
+	shaderProgram = new ShaderProgram{ "resc/shaders/voxelNormalizeComp.shader" };
+	try
+	{
+		shaderProgram->compile();
+		shaderProgram->link();
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
+	shaders.emplace("VoxelNormalize", shaderProgram);
+
+	shaderProgram = new ShaderProgram{ "resc/shaders/lightInjectionComp.shader" };
+	addVoxelFormatDefines(*shaderProgram, voxelFormat);
+	try
+	{
+		shaderProgram->compile();
+		shaderProgram->link();
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
+	shaders.emplace("LightInjection", shaderProgram);
+
+	shaderProgram = new ShaderProgram{ "resc/shaders/lightInjectionComp.shader" };
+	addVoxelFormatDefines(*shaderProgram, voxelFormat);
+	shaderProgram->addDefine("SHADOW_MAP_INJECTION");
+	try
+	{
+		shaderProgram->compile();
+		shaderProgram->link();
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
+	shaders.emplace("ShadowMapInjection", shaderProgram);
+
+	shaderProgram = new ShaderProgram{ "resc/shaders/voxelBounceComp.shader" };
+	addVoxelFormatDefines(*shaderProgram, voxelFormat);
+	try
+	{
+		shaderProgram->compile();
+		shaderProgram->link();
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
+	shaders.emplace("VoxelBounce", shaderProgram);
 	
 	// Texture init
 	textures.emplace("Concrete", new Texture2D{ "resc/conc.tga" });
 	textures.emplace("Flower", new Texture2D{ "resc/maskros512.tga" });
 	textures.emplace("Cornell", new Texture2D{ "resc/cornellUVtextureRasp.tga" });
 
-	const std::vector<GLfloat> voxelGridData(4 * voxelGridSize * voxelGridSize * voxelGridSize, 0.0f);
-	voxelGrid = new Texture3D(voxelGridData, voxelGridSize, voxelGridSize, voxelGridSize);
+	createVoxelGrid();
+	glCreateBuffers(1, &coneStepBuffer);
+	glNamedBufferStorage(coneStepBuffer, 12 * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glCreateBuffers(1, &droppedWriteBuffer);
+	glNamedBufferStorage(droppedWriteBuffer, sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glClearNamedBufferData(droppedWriteBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glCreateBuffers(1, &materialBuffer);
+	coneSet = new ConeSet();
+	glCreateVertexArrays(1, &fullscreenVao);
+	if (GLEW_ARB_pipeline_statistics_query)
+		glGenQueries(1, &fragmentQuery);
+	glGenQueries(2, overdrawQueries);
+	try
+	{
+		mipmapper = new Texture3DMipmapper(voxelFormat);
+		triangleVoxelizer = new TriangleVoxelizer();
+		shadowMap = new CubeShadowMap(256);
+		temporalAccumulator = new TemporalAccumulator();
+		stepHeatmap = new StepHeatmap("stepHeatmap.csv");
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
 
 	cam.setPosition(glm::vec3(-3.3f, 0.f, 0.f));
 }
@@ -146,14 +346,218 @@ CornellScene::CornellScene(Window* window) : GenericScene(), voxelGridSize{128},
 
 CornellScene::~CornellScene()
 {
-	delete voxelGrid;
+	destroyVoxelGrid();
+	delete mipmapper;
+	delete triangleVoxelizer;
+	delete shadowMap;
+	delete temporalAccumulator;
+	delete coneSet;
+	delete stepHeatmap;
+	delete coneTracingPrograms;
+	delete indirectDiffusePrograms;
+	delete ambientOcclusionPrograms;
+	delete deferredConeTracingPrograms;
+	glDeleteBuffers(1, &coneStepBuffer);
+	glDeleteBuffers(1, &droppedWriteBuffer);
+	glDeleteBuffers(1, &materialBuffer);
+	glDeleteVertexArrays(1, &fullscreenVao);
+	if (fragmentQuery != 0)
+		glDeleteQueries(1, &fragmentQuery);
+	glDeleteQueries(2, overdrawQueries);
+	delete gBuffer;
+	delete diffuseBuffer;
+	delete occlusionBuffer;
+
+	// Owned by sceneObjs only while it is in the scene
+	if (sparseScene)
+		delete cornellBox;
+}
+
+void CornellScene::setVoxelGridSize(int size)
+{
+	if (size == voxelGridSize)
+		return;
+
+	destroyVoxelGrid();
+	voxelGridSize = size;
+	createVoxelGrid();
+}
+
+int CornellScene::getVoxelGridSize() const
+{
+	return voxelGridSize;
+}
+
+void CornellScene::fitVoxelVolume()
+{
+	glm::vec3 sceneMin(std::numeric_limits<float>::max());
+	glm::vec3 sceneMax(-std::numeric_limits<float>::max());
+	for (auto i : sceneObjs)
+	{
+		// Dynamic objects are fitted wherever they may move, not where they happen to be now
+		glm::vec3 boundsMin, boundsMax;
+		i.second->getMotionBounds(boundsMin, boundsMax);
+		sceneMin = glm::min(sceneMin, boundsMin);
+		sceneMax = glm::max(sceneMax, boundsMax);
+	}
+
+	// Cubic voxels sized so the longest axis fits with a voxel of margin on each side for conservative rasterization
+	const glm::vec3 extent = sceneMax - sceneMin;
+	const GLfloat maxExtent = std::max({ extent.x, extent.y, extent.z });
+	voxelWorldSize = maxExtent / (voxelGridSize - 2);
+
+	// Shorter axes can get fewer voxels, kept to multiples of 8 for the mip chain and work groups
+	if (fitVoxelAspect)
+	{
+		const glm::ivec3 needed = glm::ivec3(glm::ceil(extent / voxelWorldSize)) + 2;
+		voxelGridDims = glm::min(glm::ivec3(voxelGridSize), (needed + 7) / 8 * 8);
+	}
+	else
+	{
+		voxelGridDims = glm::ivec3(voxelGridSize);
+	}
+
+	// Centre the volume on the scene and map it to 0->1 texture coordinates
+	const glm::vec3 volumeSize = glm::vec3(voxelGridDims) * voxelWorldSize;
+	const glm::vec3 volumeMin = 0.5f * (sceneMin + sceneMax) - 0.5f * volumeSize;
+	worldToVoxel = glm::scale(glm::mat4(1.f), 1.f / volumeSize) * glm::translate(glm::mat4(1.f), -volumeMin);
+	voxelToWorld = glm::inverse(worldToVoxel);
+}
+
+void CornellScene::createVoxelGrid()
+{
+	fitVoxelVolume();
+
+	const glm::ivec3& dims = voxelGridDims;
+	// Geometry and bounce volumes are only read at level 0, by texel fetches in the compute passes
+	voxelAlbedo = new Texture3D(dims.x, dims.y, dims.z, GL_RGBA8, false);
+	voxelNormal = new Texture3D(dims.x, dims.y, dims.z, GL_RGBA8, false);
+	voxelEmissive = new Texture3D(dims.x, dims.y, dims.z, GL_RGBA8, false);
+	voxelAmbient = new Texture3D(dims.x, dims.y, dims.z, GL_RGBA8, false);
+	voxelBounce = new Texture3D(dims.x, dims.y, dims.z, GL_R11F_G11F_B10F, false);
+	voxelScheduler = new VoxelUpdateScheduler(dims.z, 16);
+	voxelScheduler->setUpdateDivisor(voxelUpdateDivisor);
+	try
+	{
+		distanceField = new VoxelDistanceField(dims);
+		occupancyPyramid = new VoxelOccupancyPyramid(dims);
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		glfwTerminate();
+	}
+	createRadianceBuffers();
+
+	// Everything is voxelized again, from the cache if there is one for this size
+	voxelizedTransforms.clear();
+	geometryDirty = true;
+	voxelCacheChecked = false;
+}
+
+void CornellScene::destroyVoxelGrid()
+{
+	destroyRadianceBuffers();
+	delete voxelAlbedo;
+	delete voxelNormal;
+	delete voxelEmissive;
+	delete voxelAmbient;
+	delete voxelBounce;
+	delete voxelScheduler;
+	delete distanceField;
+	delete occupancyPyramid;
+}
+
+void CornellScene::createRadianceBuffers()
+{
+	const glm::ivec3& dims = voxelGridDims;
+	radianceBuffers.resize(giLatency + 1);
+	for (RadianceBuffer& buffer : radianceBuffers)
+	{
+		buffer.grid = new Texture3D(dims.x, dims.y, dims.z, getVoxelInternalFormat(voxelFormat));
+		buffer.opacity = hasSeparateVoxelOpacity(voxelFormat) ? new Texture3D(dims.x, dims.y, dims.z, GL_R8) : nullptr;
+		buffer.anisoGrid = nullptr;
+		try
+		{
+			buffer.anisoGrid = new AnisotropicVoxelGrid(dims, voxelFormat);
+		}
+		catch (const ShaderProgramException& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			glfwTerminate();
+		}
+		const glm::ivec3 cells = distanceField->getSize();
+		buffer.emptySpace = new Texture3D(cells.x, cells.y, cells.z, GL_R16F);
+		buffer.occupancy = new Texture3D(dims.x, dims.y, dims.z, GL_R8);
+		buffer.emptySpaceStale = true;
+		buffer.staleLayers.assign(dims.z, true);
+		buffer.written = nullptr;
+	}
+	writeBuffer = readBuffer = latestBuffer = 0;
+}
+
+void CornellScene::destroyRadianceBuffers()
+{
+	for (RadianceBuffer& buffer : radianceBuffers)
+	{
+		delete buffer.grid;
+		delete buffer.opacity;
+		delete buffer.anisoGrid;
+		delete buffer.emptySpace;
+		delete buffer.occupancy;
+		if (buffer.written != nullptr)
+			glDeleteSync(buffer.written);
+	}
+	radianceBuffers.clear();
+}
+
+void CornellScene::selectRadianceBuffers()
+{
+	const int count = (int)radianceBuffers.size();
+	writeBuffer = (latestBuffer + 1) % count;
+	readBuffer = latestBuffer;
+
+	// Without spare buffers the tracer waits for this frame's write. Otherwise the newest buffer the GPU
+	// has finished is traced, a buffer still in flight costs a frame of extra latency instead of a stall.
+	for (int i = 0; i < count - 1; ++i)
+	{
+		const int candidate = (latestBuffer - i + count) % count;
+		const GLsync fence = radianceBuffers[candidate].written;
+		if (fence == nullptr)
+			continue;
+
+		GLint status = GL_UNSIGNALED;
+		glGetSynciv(fence, GL_SYNC_STATUS, 1, nullptr, &status);
+		if (status == GL_SIGNALED)
+		{
+			readBuffer = candidate;
+			break;
+		}
+	}
+}
+
+std::vector<glm::ivec2> CornellScene::takeStaleRanges(RadianceBuffer& buffer)
+{
+	std::vector<glm::ivec2> ranges;
+	for (int z = 0; z < (int)buffer.staleLayers.size(); ++z)
+	{
+		if (!buffer.staleLayers[z])
+			continue;
+
+		if (!ranges.empty() && ranges.back().y == z)
+			++ranges.back().y;
+		else
+			ranges.push_back(glm::ivec2(z, z + 1));
+		buffer.staleLayers[z] = false;
+	}
+	return ranges;
 }
 
 void CornellScene::update(GLfloat timeDelta, GLfloat timeElapsed)
 {
 
 	light.setPosition(glm::vec3(0.5f * sin(timeElapsed), 0.5f, 0.5f * cos(timeElapsed)));
-	sceneObjs.at("Ball")->setChain(glm::vec3(20.f * sin(timeElapsed), 20.f, 20.f * cos(timeElapsed)), 0.f, glm::vec3(1.f), 0.025f * glm::vec3(1.f));
+	placeBall(*sceneObjs.at("Ball"), timeElapsed);
 	//cam.setPosition(glm::vec3(0.6f * sin(timeElapsed), 0.5f, 0.6f * cos(timeElapsed)));
 
 	if (forwardKeyPressed)
@@ -172,104 +576,979 @@ void CornellScene::update(GLfloat timeDelta, GLfloat timeElapsed)
 
 void CornellScene::drawScene()
 {
-	GLfloat clearColor[4] = { 0, 0, 0, 0 };
-	voxelGrid->Clear(clearColor);
+	profiler.begin("Frame");
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// Voxelize	
-	glViewport(0, 0, voxelGridSize, voxelGridSize);
-	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
-	ShaderProgram* shader = shaders.at("Voxelization");
-	shader->use();
-	for (auto i : sceneObjs)
+	bool geometryChanged = false;
+	if (!voxelCacheChecked)
 	{
-		voxelGrid->bind(0);
-		shader->uploadUniform("voxGrid", 0);
-		glBindImageTexture(0, voxelGrid->textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+		loadVoxelCache();
+		voxelCacheChecked = true;
+		geometryChanged = true;
+	}
 
-		i.second->setView(glm::lookAt(glm::vec3(-1.f, 0, 0), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0)));
-		i.second->setProj(orthMat);
-		shader->uploadUniform("transform", i.second->getMVP());
-		shader->uploadUniform("model", i.second->getModelTransform());
-		shader->uploadUniform("view_pos", cam.getPosition());
-		shader->uploadUniform("light", light);
-		shader->uploadUniform("material", i.second->mat);
+	// Only slabs with moved geometry are re-voxelized, a budget of slabs is relit and refiltered each frame
+	markChangedGeometry();
+	voxelScheduler->schedule();
+	for (RadianceBuffer& buffer : radianceBuffers)
+	{
+		for (const glm::ivec2& range : voxelScheduler->getUpdateRanges())
+			std::fill(buffer.staleLayers.begin() + range.x, buffer.staleLayers.begin() + range.y, true);
+	}
 
-		shader->uploadUniform("texUnit", 1);
-		textures.at(i.second->getTexture())->bind(1);
+	// With GI latency the finished buffer is traced first, so the GPU can overlap its
+	// fragment work with voxelizing the next one instead of draining between the passes
+	selectRadianceBuffers();
+	if (giLatency > 0)
+		traceCones(radianceBuffers[readBuffer]);
 
-		i.second->draw();
+	if (!voxelScheduler->getVoxelizeRanges().empty())
+	{
+		voxelizeGeometry(voxelScheduler->getVoxelizeRanges());
+		geometryChanged = true;
+	}
+	for (RadianceBuffer& buffer : radianceBuffers)
+		buffer.emptySpaceStale = buffer.emptySpaceStale || geometryChanged;
+
+	RadianceBuffer& target = radianceBuffers[writeBuffer];
+	const std::vector<glm::ivec2> ranges = takeStaleRanges(target);
+	injectLight(target, ranges);
+	generateMipmaps(target, ranges);
+
+	// Jump flooding propagates across the whole grid, so any change rebuilds the full field
+	if (target.emptySpaceStale)
+	{
+		profiler.begin("Empty space distance field");
+		distanceField->build(*voxelAlbedo, *target.emptySpace);
+		profiler.end("Empty space distance field");
+		profiler.begin("Occupancy pyramid");
+		occupancyPyramid->build(*voxelAlbedo, *target.occupancy);
+		profiler.end("Occupancy pyramid");
+		target.emptySpaceStale = false;
 	}
-	glBindTexture(GL_TEXTURE_3D, voxelGrid->textureID);
-	glGenerateMipmap(GL_TEXTURE_3D);
+	if (bounceDivisor > 0)
+		gatherBounceLight(target);
+	if (target.written != nullptr)
+		glDeleteSync(target.written);
+	target.written = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	latestBuffer = writeBuffer;
+
 	GLenum err;
 	while ((err = glGetError()) != GL_NO_ERROR) {
 		//std::cerr << "OpenGL error: " << err << std::endl;
 	}
-	
-	// Cone tracing
-	glViewport(0, 0, windowPtr->getWidth(), windowPtr->getHeight());
-	glClearColor(0.f, 0.f, 0.f, 1.0);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
-	glCullFace(GL_BACK);
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	shader = shaders.at("ConeTracing");
-	shader->use();
-	for(auto i : sceneObjs)
+
+	if (giLatency == 0)
+		traceCones(target);
+	countConeSteps = false;
+	if (measureDiffuse)
 	{
-		i.second->setView(cam.getViewMatrix());
-		i.second->setProj(projMat);
-		shader->uploadUniform("transform", i.second->getMVP());
-		shader->uploadUniform("model", i.second->getModelTransform());
-		shader->uploadUniform("view_pos", cam.getPosition());
+		measureDiffuseQuality(giLatency > 0 ? radianceBuffers[readBuffer] : target);
+		measureDiffuse = false;
+	}
 
-		shader->uploadUniform("light", light);
-		shader->uploadUniform("material", i.second->mat);
+	// Timings
+	profiler.end("Frame");
+	profiler.endFrame();
+	if (printTimings && glfwGetTime() - lastTimingReport > 1.0)
+	{
+		lastTimingReport = (GLfloat)glfwGetTime();
+		profiler.report(std::cout);
+		voxelScheduler->report(std::cout);
+		if (heatmapView >= 0)
+			stepHeatmap->report(std::cout);
 
-		shader->uploadUniform("gridSize", voxelGridSize);
-		shader->uploadUniform("Mode", cycleMode);
+		// Steps are counted in the frame after each report only, the atomics would skew the timings
+		// Per cone type: cones, steps summed, most steps of one cone and padding
+		GLuint coneSteps[12] = {};
+		glGetNamedBufferSubData(coneStepBuffer, 0, sizeof(coneSteps), coneSteps);
+		const char* coneTypes[3] = { "Diffuse", "Specular", "Shadow" };
+		for (int type = 0; type < 3; ++type)
+		{
+			const GLuint* counts = coneSteps + 4 * type;
+			if (counts[0] > 0)
+				std::cout << coneTypes[type] << " cone steps: " << (double)counts[1] / counts[0] << " mean, " << counts[2] << " max over "
+					<< counts[0] << " cones" << getEmptySpaceSkippingName() << (sparseScene ? " in the sparse scene" : " in the Cornell box") << ", capped at " << maxConeSteps << std::endl;
+		}
+		glClearNamedBufferData(coneStepBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		countConeSteps = true;
 
-		shader->uploadUniform("texUnit", 1);
-		textures.at(i.second->getTexture())->bind(1);
+		// Atomic averaging gives up on a voxel after 255 contended retries, the fragment is then lost
+		GLuint droppedWrites = 0;
+		glGetNamedBufferSubData(droppedWriteBuffer, 0, sizeof(droppedWrites), &droppedWrites);
+		if (droppedWrites > 0)
+		{
+			std::cout << "Atomic voxel writes dropped since the last report: " << droppedWrites << std::endl;
+			glClearNamedBufferData(droppedWriteBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		}
 
-		voxelGrid->bind(0);
-		shader->uploadUniform("voxGrid", 0);
+		// Fragment shader invocations of the cone tracing pass, overdraw included on the forward path
+		GLuint available = GL_FALSE;
+		if (fragmentQueryPending)
+			glGetQueryObjectuiv(fragmentQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_TRUE)
+		{
+			GLuint64 fragments = 0;
+			glGetQueryObjectui64v(fragmentQuery, GL_QUERY_RESULT, &fragments);
+			std::cout << "Shaded fragments: " << fragments << (fragmentQueryDeferred ? " (deferred)" : " (forward)") << std::endl;
+			fragmentQueryPending = false;
+		}
 
-		i.second->draw();
+		// Fragments passing the depth test of the cone tracing pass against the pixels visible in the end
+		available = GL_FALSE;
+		if (overdrawQueryPending)
+			glGetQueryObjectuiv(overdrawQueries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_TRUE)
+		{
+			GLuint64 shaded = 0, visible = 0;
+			glGetQueryObjectui64v(overdrawQueries[0], GL_QUERY_RESULT, &shaded);
+			glGetQueryObjectui64v(overdrawQueries[1], GL_QUERY_RESULT, &visible);
+			std::cout << "Overdraw: " << shaded << " cone traced fragments for " << visible << " visible pixels ("
+				<< (visible > 0 ? (double)shaded / visible : 0.0) << "x)" << (depthPrepass ? " with" : " without") << " depth pre-pass" << std::endl;
+			overdrawQueryPending = false;
+		}
+		std::cout << std::endl;
 	}
 }
 
-void CornellScene::handleEvent(WindowEvent& ev,  GLfloat timedelta)
+glm::ivec2 CornellScene::worldToVoxelLayers(GLfloat zMin, GLfloat zMax) const
 {
-	switch (ev.type)
+	// The volume is axis aligned, so z only depends on z. A layer of margin for conservative rasterization.
+	const GLfloat scale = worldToVoxel[2][2] * voxelGridDims.z;
+	const GLfloat offset = worldToVoxel[3][2] * voxelGridDims.z;
+	const int first = (int)std::floor(scale * zMin + offset) - 1;
+	const int last = (int)std::ceil(scale * zMax + offset) + 1;
+	return glm::ivec2(glm::clamp(first, 0, voxelGridDims.z), glm::clamp(last, 0, voxelGridDims.z));
+}
+
+void CornellScene::loadVoxelCache()
+{
+	// Lights are left out of the key as they are injected every frame, dynamic objects as they are never cached
+	std::uint64_t key = hashBytes(&voxelGridDims[0], sizeof(voxelGridDims));
+	key = hashBytes(&worldToVoxel[0][0], sizeof(worldToVoxel), key);
+
+	// Every setting changing which voxels get written or how they are averaged, conservative raster depends on the driver
+	const std::int32_t settings[] = { atomicVoxelization, static_cast<std::int32_t>(voxelizationPath),
+		hardwareConservativeRaster, shaderDilation, hybridVoxelization };
+	key = hashBytes(settings, sizeof(settings), key);
+	for (auto i : sceneObjs)
 	{
-	case EventType::KEY_EVENT:
-		if (ev.key.key == GLFW_KEY_W)
+		if (!i.second->isDynamic())
 		{
-			if (ev.key.action == Action::PRESS)
-				forwardKeyPressed = true;
-			else if (ev.key.action == Action::RELEASE)
-				forwardKeyPressed = false;
+			key = hashBytes(i.first.data(), i.first.size(), key);
+			key = i.second->getVoxelHash(key);
 		}
-		else if (ev.key.key == GLFW_KEY_S)
+	}
+
+	std::ostringstream prefix;
+	prefix << "resc/voxelcache_" << std::hex << std::setw(16) << std::setfill('0') << key;
+	const std::string albedoPath = prefix.str() + "_albedo.vox";
+	const std::string normalPath = prefix.str() + "_normal.vox";
+	const std::string emissivePath = prefix.str() + "_emissive.vox";
+	const std::string ambientPath = prefix.str() + "_ambient.vox";
+
+	if (voxelAlbedo->load(albedoPath) && voxelNormal->load(normalPath) && voxelEmissive->load(emissivePath)
+		&& voxelAmbient->load(ambientPath))
+	{
+		std::cout << "Loaded voxel grid " << prefix.str() << std::endl;
+	}
+	else
+	{
+		voxelizeGeometry({ glm::ivec2(0, voxelGridDims.z) }, false);
+		if (voxelAlbedo->save(albedoPath) && voxelNormal->save(normalPath) && voxelEmissive->save(emissivePath)
+			&& voxelAmbient->save(ambientPath))
+			std::cout << "Stored voxel grid " << prefix.str() << std::endl;
+		else
+			std::cerr << "Could not store voxel grid " << prefix.str() << std::endl;
+	}
+
+	// Dynamic objects have no stored transform and get voxelized on top by the scheduler
+	for (auto i : sceneObjs)
+	{
+		if (!i.second->isDynamic())
+			voxelizedTransforms[i.first] = i.second->getModelTransform();
+	}
+	voxelScheduler->markAllClean();
+	geometryDirty = false;
+}
+
+void CornellScene::markChangedGeometry()
+{
+	if (geometryDirty)
+	{
+		voxelScheduler->markAllDirty();
+		geometryDirty = false;
+	}
+
+	for (auto i : sceneObjs)
+	{
+		glm::vec3 boundsMin, boundsMax;
+		i.second->getWorldBounds(boundsMin, boundsMax);
+		const glm::ivec2 layers = worldToVoxelLayers(boundsMin.z, boundsMax.z);
+
+		const glm::mat4 model = i.second->getModelTransform();
+		auto it = voxelizedTransforms.find(i.first);
+		if (it == voxelizedTransforms.end())
 		{
-			if (ev.key.action == Action::PRESS)
-				backwardKeyPressed = true;
-			else if (ev.key.action == Action::RELEASE)
-				backwardKeyPressed = false;
+			voxelizedTransforms[i.first] = model;
+			voxelScheduler->markDirty(layers.x, layers.y);
 		}
-		else if (ev.key.key == GLFW_KEY_A)
+		else if (it->second != model)
 		{
-			if (ev.key.action == Action::PRESS)
-				leftKeyPressed = true;
-			else if (ev.key.action == Action::RELEASE)
+			// The footprint at the previous position has to be cleared as well
+			glm::vec3 oldMin, oldMax;
+			i.second->getWorldBounds(it->second, oldMin, oldMax);
+			const glm::ivec2 oldLayers = worldToVoxelLayers(oldMin.z, oldMax.z);
+			voxelScheduler->markDirty(oldLayers.x, oldLayers.y);
+			voxelScheduler->markDirty(layers.x, layers.y);
+			it->second = model;
+		}
+
+		if (i.second->isDynamic())
+			voxelScheduler->markPriority(layers.x, layers.y);
+	}
+}
+
+void CornellScene::voxelizeGeometry(const std::vector<glm::ivec2>& ranges, bool includeDynamic)
+{
+	profiler.begin("Voxelization");
+
+	GLfloat clearColor[4] = { 0, 0, 0, 0 };
+	for (const glm::ivec2& range : ranges)
+	{
+		const glm::ivec3 offset(0, 0, range.x);
+		const glm::ivec3 size(voxelGridDims.x, voxelGridDims.y, range.y - range.x);
+		voxelAlbedo->Clear(clearColor, offset, size);
+		voxelNormal->Clear(clearColor, offset, size);
+		voxelEmissive->Clear(clearColor, offset, size);
+		voxelAmbient->Clear(clearColor, offset, size);
+	}
+
+	// Triangles are projected along their dominant axis, either onto a square of the largest grid
+	// dimension or into the viewport of that axis
+	if (voxelizationPath == VOXELIZATION_PATH::GEOMETRY_SHADER)
+	{
+		const int viewportSize = std::max({ voxelGridDims.x, voxelGridDims.y, voxelGridDims.z });
+		glViewport(0, 0, viewportSize, viewportSize);
+	}
+	else
+	{
+		glViewportIndexedf(0, 0.f, 0.f, (GLfloat)voxelGridDims.y, (GLfloat)voxelGridDims.z);
+		glViewportIndexedf(1, 0.f, 0.f, (GLfloat)voxelGridDims.x, (GLfloat)voxelGridDims.z);
+		glViewportIndexedf(2, 0.f, 0.f, (GLfloat)voxelGridDims.x, (GLfloat)voxelGridDims.y);
+	}
+	if (hardwareConservativeRaster)
+	{
+		if (shaderDilation)
+			glDisable(GL_CONSERVATIVE_RASTERIZATION_NV);
+		else
+			glEnable(GL_CONSERVATIVE_RASTERIZATION_NV);
+	}
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	// Image units 0-3 hold albedo, normal, emissive and ambient, 4-7 the same volumes viewed as R32UI
+	const Texture3D* geometryVolumes[4] = { voxelAlbedo, voxelNormal, voxelEmissive, voxelAmbient };
+	for (GLuint i = 0; i < 4; ++i)
+	{
+		glBindImageTexture(i, geometryVolumes[i]->textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+		glBindImageTexture(4 + i, geometryVolumes[i]->textureID, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, droppedWriteBuffer);
+
+	const bool pulling = voxelizationPath == VOXELIZATION_PATH::VERTEX_PULLING;
+	std::string pathSection = pulling ? "Voxelization (vertex pulling"
+		: (voxelizationPath == VOXELIZATION_PATH::VIEWPORT_ARRAY ? "Voxelization (viewport array" : "Voxelization (geometry shader");
+	pathSection += hybridVoxelization ? " + compute)" : ")";
+	profiler.begin(pathSection);
+
+	// Small triangles are written by the compute voxelizer, the rest left for the raster shader
+	ShaderProgram* compute = hybridVoxelization ? &triangleVoxelizer->getShader() : nullptr;
+	if (compute != nullptr)
+	{
+		compute->uploadUniform("worldToVoxel", worldToVoxel);
+		compute->uploadUniform("gridDims", voxelGridDims);
+		compute->uploadUniform("atomicAverage", atomicVoxelization ? 1 : 0);
+	}
+
+	ShaderProgram* shader = shaders.at(pulling ? "VoxelizationPulled" : "Voxelization");
+	shader->use();
+	shader->uploadUniform("worldToVoxel", worldToVoxel);
+	shader->uploadUniform("voxelToWorld", voxelToWorld);
+	shader->uploadUniform("gridDims", voxelGridDims);
+	shader->uploadUniform("viewportArray", voxelizationPath == VOXELIZATION_PATH::VIEWPORT_ARRAY ? 1 : 0);
+	shader->uploadUniform("dilate", shaderDilation ? 1 : 0);
+	for (auto i : sceneObjs)
+	{
+		if (!includeDynamic && i.second->isDynamic())
+			continue;
+
+		glm::vec3 boundsMin, boundsMax;
+		i.second->getWorldBounds(boundsMin, boundsMax);
+		const glm::ivec2 layers = worldToVoxelLayers(boundsMin.z, boundsMax.z);
+
+		shader->uploadUniform("atomicAverage", atomicVoxelization ? 1 : 0);
+
+		i.second->setView(glm::lookAt(glm::vec3(-1.f, 0, 0), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0)));
+		i.second->setProj(orthMat);
+		shader->uploadUniform("transform", i.second->getMVP());
+		shader->uploadUniform("model", i.second->getModelTransform());
+		shader->uploadUniform("material", i.second->mat);
+		shader->uploadUniform("hasTexCoords", i.second->hasTextureCoordinates() ? 1 : 0);
+
+		shader->uploadUniform("texUnit", 1);
+		textures.at(i.second->getTexture())->bind(1);
+
+		if (compute != nullptr)
+		{
+			compute->uploadUniform("model", i.second->getModelTransform());
+			compute->uploadUniform("material", i.second->mat);
+			compute->uploadUniform("hasTexCoords", i.second->hasTextureCoordinates() ? 1 : 0);
+			compute->uploadUniform("texUnit", 1);
+		}
+
+		profiler.begin("Voxelization " + i.first);
+		for (const glm::ivec2& range : ranges)
+		{
+			// Objects outside the slabs are skipped, fragments outside are discarded
+			if (layers.x >= range.y || layers.y <= range.x)
+				continue;
+
+			shader->uploadUniform("slabRange", range);
+			if (compute != nullptr)
+			{
+				compute->uploadUniform("slabRange", range);
+				triangleVoxelizer->voxelize(i.second->getModel());
+				shader->use();
+				triangleVoxelizer->drawLargeTriangles(i.second->getModel(), pulling);
+			}
+			else if (pulling)
+				i.second->drawVertexPulling();
+			else
+				i.second->draw();
+		}
+		profiler.end("Voxelization " + i.first);
+	}
+	profiler.end(pathSection);
+
+	// Atomic averaging leaves the fragment count in alpha
+	if (atomicVoxelization)
+	{
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		for (GLuint i = 0; i < 4; ++i)
+			glBindImageTexture(i, geometryVolumes[i]->textureID, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA8);
+		const glm::ivec3 groups = (voxelGridDims + 3) / 4;
+		shaders.at("VoxelNormalize")->dispatch(groups.x, groups.y, groups.z);
+	}
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	profiler.end("Voxelization");
+}
+
+void CornellScene::injectLight(RadianceBuffer& target, const std::vector<glm::ivec2>& ranges)
+{
+	// With the shadow map, the voxel pass leaves out direct light and the voxels the light sees are relit from its texels
+	const bool useShadowMap = shadowMapInjection && !ranges.empty();
+	if (useShadowMap)
+	{
+		profiler.begin("Shadow map");
+		shadowMap->render(light.getPosition(), sceneObjs);
+		profiler.end("Shadow map");
+	}
+
+	profiler.begin("Light injection");
+
+	ShaderProgram* shader = shaders.at("LightInjection");
+	ShaderProgram* shadowShader = useShadowMap ? shaders.at("ShadowMapInjection") : nullptr;
+
+	voxelAlbedo->bind(0);
+	voxelNormal->bind(1);
+	voxelEmissive->bind(2);
+	voxelBounce->bind(3);
+	voxelAmbient->bind(4);
+	for (ShaderProgram* program : { shader, shadowShader })
+	{
+		if (program == nullptr)
+			continue;
+
+		program->uploadUniform("voxAlbedo", 0);
+		program->uploadUniform("voxNormal", 1);
+		program->uploadUniform("voxEmissive", 2);
+		program->uploadUniform("voxBounce", 3);
+		program->uploadUniform("voxAmbient", 4);
+		program->uploadUniform("multiBounce", bounceDivisor > 0 ? 1 : 0);
+		program->uploadUniform("light", light);
+		program->uploadUniform("voxelToWorld", voxelToWorld);
+	}
+	shader->uploadUniform("directLight", useShadowMap ? 0 : 1);
+
+	glBindImageTexture(0, target.grid->textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, target.grid->getFormat());
+	if (target.opacity != nullptr)
+		glBindImageTexture(1, target.opacity->textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+
+	const glm::ivec3 groups = (voxelGridDims + 3) / 4;
+	for (const glm::ivec2& range : ranges)
+	{
+		shader->uploadUniform("regionOffset", glm::ivec3(0, 0, range.x));
+		shader->uploadUniform("regionSize", glm::ivec3(voxelGridDims.x, voxelGridDims.y, range.y - range.x));
+		shader->dispatch(groups.x, groups.y, (range.y - range.x + 3) / 4);
+	}
+
+	// The sweep above still visits every voxel of the ranges for ambient and emission, this pass only adds
+	// the direct light, at a cost that follows the shadow map resolution rather than the number of voxels
+	if (shadowShader != nullptr)
+	{
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		shadowMap->bindImage(2);
+		shadowShader->uploadUniform("worldToVoxel", worldToVoxel);
+		const GLuint texelGroups = (shadowMap->getResolution() + 7) / 8;
+		for (const glm::ivec2& range : ranges)
+		{
+			shadowShader->uploadUniform("regionOffset", glm::ivec3(0, 0, range.x));
+			shadowShader->uploadUniform("regionSize", glm::ivec3(voxelGridDims.x, voxelGridDims.y, range.y - range.x));
+			shadowShader->dispatch(texelGroups, texelGroups, 6);
+		}
+	}
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+	profiler.end("Light injection");
+}
+
+void CornellScene::generateMipmaps(RadianceBuffer& target, const std::vector<glm::ivec2>& ranges)
+{
+	if (ranges.empty())
+		return;
+
+	// Directional volumes replace the isotropic mip chain when enabled
+	if (anisotropicVoxels)
+	{
+		profiler.begin("Mipmap (anisotropic)");
+		for (const glm::ivec2& range : ranges)
+			target.anisoGrid->build(*target.grid, target.opacity, glm::ivec3(0, 0, range.x), glm::ivec3(voxelGridDims.x, voxelGridDims.y, range.y));
+		profiler.end("Mipmap (anisotropic)");
+	}
+	else if (computeMipmaps)
+	{
+		profiler.begin("Mipmap (compute)");
+		for (const glm::ivec2& range : ranges)
+			mipmapper->generateMipmaps(*target.grid, target.opacity, glm::ivec3(0, 0, range.x), glm::ivec3(voxelGridDims.x, voxelGridDims.y, range.y));
+		profiler.end("Mipmap (compute)");
+	}
+	else
+	{
+		// Always rebuilds the whole chain
+		profiler.begin("Mipmap (glGenerateMipmap)");
+		glBindTexture(GL_TEXTURE_3D, target.grid->textureID);
+		glGenerateMipmap(GL_TEXTURE_3D);
+		if (target.opacity != nullptr)
+		{
+			glBindTexture(GL_TEXTURE_3D, target.opacity->textureID);
+			glGenerateMipmap(GL_TEXTURE_3D);
+		}
+		profiler.end("Mipmap (glGenerateMipmap)");
+	}
+}
+
+void CornellScene::gatherBounceLight(const RadianceBuffer& source)
+{
+	profiler.begin("Multi-bounce");
+
+	ShaderProgram* shader = shaders.at("VoxelBounce");
+	shader->use();
+
+	// Units 0-15 are all taken with a separate opacity volume
+	voxelAlbedo->bind(0);
+	shader->uploadUniform("voxAlbedo", 0);
+	voxelNormal->bind(1);
+	shader->uploadUniform("voxNormal", 1);
+	source.grid->bind(2);
+	shader->uploadUniform("voxGrid", 2);
+	shader->uploadUniform("anisotropic", anisotropicVoxels ? 1 : 0);
+	source.anisoGrid->bind(3);
+	for (int dir = 0; dir < 6; ++dir)
+		shader->uploadUniform("voxAniso[" + std::to_string(dir) + "]", 3 + dir);
+	if (source.opacity != nullptr)
+	{
+		source.opacity->bind(9);
+		shader->uploadUniform("voxOpacity", 9);
+		source.anisoGrid->bindOpacity(10);
+		for (int dir = 0; dir < 6; ++dir)
+			shader->uploadUniform("voxAnisoOpacity[" + std::to_string(dir) + "]", 10 + dir);
+	}
+
+	// Each frame one share of the voxels is gathered, interleaved so every region converges at the same rate
+	shader->uploadUniform("phase", bouncePhase);
+	shader->uploadUniform("phaseCount", bounceDivisor);
+	bouncePhase = (bouncePhase + 1) % bounceDivisor;
+
+	glBindImageTexture(0, voxelBounce->textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R11F_G11F_B10F);
+	const glm::ivec3 groups = (voxelGridDims + 3) / 4;
+	shader->dispatch(groups.x, groups.y, groups.z);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	profiler.end("Multi-bounce");
+}
+
+void CornellScene::renderGBuffer()
+{
+	profiler.begin("G-buffer");
+	const int width = (int)windowPtr->getWidth();
+	const int height = (int)windowPtr->getHeight();
+	if (gBuffer == nullptr || gBuffer->getWidth() != width || gBuffer->getHeight() != height)
+	{
+		delete gBuffer;
+		gBuffer = new GBuffer(width, height);
+	}
+
+	gBuffer->bindForWriting();
+	glDisable(GL_BLEND);
+
+	// Material table in std430 layout, three padded vec3 followed by four floats
+	std::vector<GLfloat> materials;
+	materials.reserve(16 * sceneObjs.size());
+
+	ShaderProgram* shader = shaders.at("GBuffer");
+	shader->use();
+	for (auto i : sceneObjs)
+	{
+		const Material& mat = i.second->mat;
+		const glm::vec3 ambient = mat.getAmbient();
+		const glm::vec3 diffuse = mat.getDiffuse();
+		const glm::vec3 specular = mat.getSpecular();
+		shader->uploadUniform("materialIndex", (int)(materials.size() / 16));
+		materials.insert(materials.end(), {
+			ambient.x, ambient.y, ambient.z, 0.f,
+			diffuse.x, diffuse.y, diffuse.z, 0.f,
+			specular.x, specular.y, specular.z, mat.getShininess(),
+			mat.getEmissivity(), mat.getDiffuseReflectivity(), mat.getSpecularReflectivity(), 0.f });
+
+		i.second->setView(cam.getViewMatrix());
+		i.second->setProj(projMat);
+		shader->uploadUniform("transform", i.second->getMVP());
+		shader->uploadUniform("model", i.second->getModelTransform());
+		shader->uploadUniform("texUnit", 1);
+		textures.at(i.second->getTexture())->bind(1);
+		i.second->draw();
+	}
+
+	glNamedBufferData(materialBuffer, materials.size() * sizeof(GLfloat), materials.data(), GL_DYNAMIC_DRAW);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	profiler.end("G-buffer");
+}
+
+void CornellScene::drawDepthOnly()
+{
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	ShaderProgram* shader = shaders.at("DepthOnly");
+	shader->use();
+	for (auto i : sceneObjs)
+	{
+		i.second->setView(cam.getViewMatrix());
+		i.second->setProj(projMat);
+		shader->uploadUniform("transform", i.second->getMVP());
+		shader->uploadUniform("model", i.second->getModelTransform());
+		i.second->draw();
+	}
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void CornellScene::bindConeTracingInputs(ShaderProgram& shader, const RadianceBuffer& source)
+{
+	shader.uploadUniform("view_pos", cam.getPosition());
+	shader.uploadUniform("light", light);
+	shader.uploadUniform("worldToVoxel", worldToVoxel);
+	shader.uploadUniform("voxelWorldSize", voxelWorldSize);
+
+	source.grid->bind(0);
+	shader.uploadUniform("voxGrid", 0);
+
+	shader.uploadUniform("anisotropic", anisotropicVoxels ? 1 : 0);
+	source.anisoGrid->bind(2);
+	for (int dir = 0; dir < 6; ++dir)
+		shader.uploadUniform("voxAniso[" + std::to_string(dir) + "]", 2 + dir);
+
+	// Units 8-14 hold opacity for formats without alpha
+	if (source.opacity != nullptr)
+	{
+		source.opacity->bind(8);
+		shader.uploadUniform("voxOpacity", 8);
+		source.anisoGrid->bindOpacity(9);
+		for (int dir = 0; dir < 6; ++dir)
+			shader.uploadUniform("voxAnisoOpacity[" + std::to_string(dir) + "]", 9 + dir);
+	}
+
+	shader.uploadUniform("emptySpaceMode", (int)emptySpaceSkipping);
+	source.emptySpace->bind(15);
+	shader.uploadUniform("emptySpace", 15);
+	shader.uploadUniform("emptySpaceCellSize", VoxelDistanceField::CELL_SIZE);
+	if (occupancyUnit >= 0)
+	{
+		source.occupancy->bind(occupancyUnit);
+		shader.uploadUniform("occupancy", occupancyUnit);
+		shader.uploadUniform("occupancyTopLevel", occupancyPyramid->getTopLevel());
+	}
+	shader.uploadUniform("countSteps", countConeSteps ? 1 : 0);
+	shader.uploadUniform("maxConeSteps", maxConeSteps);
+
+	// Ambient occlusion reaches eight voxels, the contact shadows the diffuse cones are too coarse for
+	shader.uploadUniform("occlusionRange", 8.f * voxelWorldSize);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, coneStepBuffer);
+
+	const glm::vec3 volumeExtent = 1.f / glm::vec3(worldToVoxel[0][0], worldToVoxel[1][1], worldToVoxel[2][2]);
+	coneSet->update(diffuseCones, voxelWorldSize, volumeExtent);
+	coneSet->bind(0, 2);
+}
+
+void CornellScene::traceIndirectDiffuse(ShaderProgram& program, const RadianceBuffer& source)
+{
+	profiler.begin("Reduced indirect diffuse");
+	const int width = (int)windowPtr->getWidth();
+	const int height = (int)windowPtr->getHeight();
+	if (diffuseBuffer == nullptr || diffuseBuffer->getWindowWidth() != width || diffuseBuffer->getWindowHeight() != height
+		|| diffuseBuffer->getScale() != diffuseScale)
+	{
+		delete diffuseBuffer;
+		diffuseBuffer = new IndirectDiffuseBuffer(width, height, diffuseScale);
+	}
+
+	// Rasterized at the reduced resolution, each pixel traces the surface at its centre
+	diffuseBuffer->bindForWriting();
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+
+	ShaderProgram* shader = &program;
+	shader->use();
+	bindConeTracingInputs(*shader, source);
+	shader->uploadUniform("coneFrame", temporalDiffuse ? temporalAccumulator->getFrame() : -1);
+	for (auto i : sceneObjs)
+	{
+		i.second->setView(cam.getViewMatrix());
+		i.second->setProj(projMat);
+		const glm::mat4 transform = i.second->getMVP();
+		auto previous = previousTransforms.find(i.first);
+		shader->uploadUniform("transform", transform);
+		shader->uploadUniform("previousTransform", previous == previousTransforms.end() ? transform : previous->second);
+		shader->uploadUniform("model", i.second->getModelTransform());
+		i.second->draw();
+		previousTransforms[i.first] = transform;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	profiler.end("Reduced indirect diffuse");
+
+	if (temporalDiffuse)
+	{
+		profiler.begin("Temporal accumulation");
+		temporalAccumulator->accumulate(*diffuseBuffer, 0.1f);
+		profiler.end("Temporal accumulation");
+	}
+}
+
+const char* CornellScene::getEmptySpaceSkippingName() const
+{
+	switch (emptySpaceSkipping)
+	{
+	case EMPTY_SPACE_SKIPPING::DISTANCE_FIELD:
+		return " with the distance field";
+	case EMPTY_SPACE_SKIPPING::OCCUPANCY_PYRAMID:
+		return " with the occupancy pyramid";
+	default:
+		return " without empty space skipping";
+	}
+}
+
+bool CornellScene::usesAmbientOcclusion() const
+{
+	// Views with an ambient or indirect diffuse term, and the view of the occlusion itself
+	return cycleMode == 6 || (ambientOcclusion && (cycleMode == 1 || cycleMode == 3 || cycleMode == 5));
+}
+
+void CornellScene::traceAmbientOcclusion(ShaderProgram& program, const RadianceBuffer& source)
+{
+	const std::string section = "Ambient occlusion 1/" + std::to_string(occlusionScale);
+	profiler.begin(section);
+	const int width = (int)windowPtr->getWidth();
+	const int height = (int)windowPtr->getHeight();
+	if (occlusionBuffer == nullptr || occlusionBuffer->getWindowWidth() != width || occlusionBuffer->getWindowHeight() != height
+		|| occlusionBuffer->getScale() != occlusionScale)
+	{
+		delete occlusionBuffer;
+		occlusionBuffer = new AmbientOcclusionBuffer(width, height, occlusionScale);
+	}
+
+	// Rasterized at the reduced resolution like the indirect diffuse, each pixel traces the surface at its centre
+	occlusionBuffer->bindForWriting();
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+
+	program.use();
+	bindConeTracingInputs(program, source);
+	for (auto i : sceneObjs)
+	{
+		i.second->setView(cam.getViewMatrix());
+		i.second->setProj(projMat);
+		program.uploadUniform("transform", i.second->getMVP());
+		program.uploadUniform("model", i.second->getModelTransform());
+		i.second->draw();
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	profiler.end(section);
+}
+
+ShaderFeatures CornellScene::getConeTracingFeatures() const
+{
+	// Features a view does not use keep their defaults, so each of those views compiles once.
+	// The diffuse cone set is not a feature, it comes from the ConeSet buffers
+	const bool combined = cycleMode == 5;
+	ShaderFeatures features = {
+		{ "VIEW", std::to_string(cycleMode) },
+		{ "SPECULAR", !combined || specularCones ? "1" : "0" },
+		{ "SHADOWS", !combined || shadowCones ? "1" : "0" },
+		{ "AMBIENT_OCCLUSION", usesAmbientOcclusion() ? "1" : "0" }
+	};
+	if (heatmapView >= 0)
+		features.push_back({ "STEP_HEATMAP", "1" });
+	return features;
+}
+
+ShaderProgram* CornellScene::getPermutation(ShaderPermutationCache& cache, const ShaderFeatures& features)
+{
+	try
+	{
+		return &cache.get(features);
+	}
+	catch (const ShaderProgramException& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		return nullptr;
+	}
+}
+
+void CornellScene::traceCones(const RadianceBuffer& source)
+{
+	profiler.begin("Cone tracing");
+	const bool separateDiffuse = (diffuseScale > 1 || temporalDiffuse) && (cycleMode == 3 || cycleMode == 5);
+	const ShaderFeatures features = getConeTracingFeatures();
+	ShaderProgram* shader = getPermutation(deferredShading ? *deferredConeTracingPrograms : *coneTracingPrograms, features);
+	ShaderProgram* diffuseShader = separateDiffuse ? getPermutation(*indirectDiffusePrograms, {}) : nullptr;
+	const bool occlusion = usesAmbientOcclusion();
+	ShaderProgram* occlusionShader = occlusion ? getPermutation(*ambientOcclusionPrograms, {}) : nullptr;
+	if (shader == nullptr || (separateDiffuse && diffuseShader == nullptr) || (occlusion && occlusionShader == nullptr))
+	{
+		profiler.end("Cone tracing");
+		return;
+	}
+	if (separateDiffuse)
+		traceIndirectDiffuse(*diffuseShader, source);
+	if (occlusion)
+		traceAmbientOcclusion(*occlusionShader, source);
+
+	glViewport(0, 0, windowPtr->getWidth(), windowPtr->getHeight());
+	glClearColor(0.f, 0.f, 0.f, 1.0);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+	if (deferredShading)
+	{
+		renderGBuffer();
+	}
+	else if (depthPrepass)
+	{
+		// Cheap pass resolving visibility, the cone tracing shader then only passes GL_EQUAL once per pixel
+		profiler.begin("Depth pre-pass");
+		drawDepthOnly();
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+		profiler.end("Depth pre-pass");
+	}
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	shader->use();
+	bindConeTracingInputs(*shader, source);
+
+	// Reduced or accumulated indirect diffuse only matters to the modes that show it
+	shader->uploadUniform("reducedDiffuse", separateDiffuse ? 1 : 0);
+	if (separateDiffuse)
+	{
+		shader->uploadUniform("diffuseScale", diffuseScale);
+		diffuseBuffer->bindImages(3);
+		if (temporalDiffuse)
+			temporalAccumulator->bindResult(3);
+	}
+
+	// Bound after the diffuse buffer, whose motion attachment on unit 5 this pass does not read
+	if (occlusion)
+	{
+		shader->uploadUniform("occlusionScale", occlusionScale);
+		occlusionBuffer->bindImages(5, 7);
+	}
+
+	const bool heatmap = heatmapView >= 0;
+	if (heatmap)
+	{
+		stepHeatmap->begin((int)windowPtr->getWidth(), (int)windowPtr->getHeight());
+		stepHeatmap->bindImage(6);
+	}
+
+	const bool queryFragments = countConeSteps && fragmentQuery != 0;
+	if (queryFragments)
+		glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, fragmentQuery);
+	const bool queryOverdraw = countConeSteps && !deferredShading;
+	if (queryOverdraw)
+		glBeginQuery(GL_SAMPLES_PASSED, overdrawQueries[0]);
+
+	// Timed per permutation, so the report compares the feature sets used during the run
+	std::string shadingSection = "Shading [" + ShaderPermutationCache::getKey(features) + "]";
+	if (cycleMode == 3 || cycleMode == 5)
+		shadingSection += " " + std::to_string(diffuseCones) + " cones";
+	profiler.begin(shadingSection);
+	if (deferredShading)
+	{
+		// The G-buffer already resolved visibility, one triangle shades every covered pixel once
+		glDisable(GL_DEPTH_TEST);
+		gBuffer->bindImages(0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, materialBuffer);
+		glBindVertexArray(fullscreenVao);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glBindVertexArray(0);
+		glEnable(GL_DEPTH_TEST);
+	}
+	else
+	{
+		for (auto i : sceneObjs)
+		{
+			i.second->setView(cam.getViewMatrix());
+			i.second->setProj(projMat);
+			shader->uploadUniform("transform", i.second->getMVP());
+			shader->uploadUniform("model", i.second->getModelTransform());
+			shader->uploadUniform("material", i.second->mat);
+
+			shader->uploadUniform("texUnit", 1);
+			textures.at(i.second->getTexture())->bind(1);
+
+			i.second->draw();
+		}
+	}
+	profiler.end(shadingSection);
+
+	if (queryFragments)
+	{
+		glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+		fragmentQueryPending = true;
+		fragmentQueryDeferred = deferredShading;
+	}
+	if (queryOverdraw)
+	{
+		// Counting frames only: the final depth buffer tells how many pixels ended up visible
+		glEndQuery(GL_SAMPLES_PASSED);
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+		glBeginQuery(GL_SAMPLES_PASSED, overdrawQueries[1]);
+		drawDepthOnly();
+		glEndQuery(GL_SAMPLES_PASSED);
+		overdrawQueryPending = true;
+	}
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	profiler.end("Cone tracing");
+
+	if (heatmap)
+	{
+		// Reads back every frame, the timings of a run with the heatmap on are not representative
+		stepHeatmap->collect(profiler.getMilliseconds("Cone tracing"));
+		stepHeatmap->draw(heatmapView);
+	}
+}
+
+void CornellScene::measureDiffuseQuality(const RadianceBuffer& source)
+{
+	const int width = (int)windowPtr->getWidth();
+	const int height = (int)windowPtr->getHeight();
+	const int scale = diffuseScale;
+	const bool temporal = temporalDiffuse;
+	const int heatmap = heatmapView;
+
+	// The full resolution reference first, the reduced frame is left on screen
+	std::vector<GLubyte> pixels[2];
+	GLuint64 nanoseconds[2];
+	GLuint queries[2];
+	glGenQueries(2, queries);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	heatmapView = -1;
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		diffuseScale = pass == 0 ? 1 : scale;
+		temporalDiffuse = pass == 0 ? false : temporal;
+		glQueryCounter(queries[0], GL_TIMESTAMP);
+		traceCones(source);
+		glQueryCounter(queries[1], GL_TIMESTAMP);
+
+		pixels[pass].resize(3 * width * height);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels[pass].data());
+		GLuint64 start, stop;
+		glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &stop);
+		nanoseconds[pass] = stop - start;
+	}
+	glDeleteQueries(2, queries);
+	diffuseScale = scale;
+	temporalDiffuse = temporal;
+	heatmapView = heatmap;
+
+	double squaredError = 0.0;
+	for (size_t i = 0; i < pixels[0].size(); ++i)
+	{
+		const double diff = (double)pixels[0][i] - (double)pixels[1][i];
+		squaredError += diff * diff;
+	}
+	const double mse = squaredError / pixels[0].size();
+
+	std::cout << "Indirect diffuse at 1/" << scale << " resolution" << (temporal ? " with temporal accumulation: " : ": ") << std::fixed << std::setprecision(3)
+		<< nanoseconds[1] / 1.0e6 << " ms against " << nanoseconds[0] / 1.0e6 << " ms at full resolution, PSNR ";
+	if (mse > 0.0)
+		std::cout << 10.0 * std::log10(255.0 * 255.0 / mse) << " dB" << std::endl;
+	else
+		std::cout << "infinite" << std::endl;
+	std::cout.unsetf(std::ios::fixed);
+}
+
+void CornellScene::handleEvent(WindowEvent& ev,  GLfloat timedelta)
+{
+	switch (ev.type)
+	{
+	case EventType::KEY_EVENT:
+		if (ev.key.key == GLFW_KEY_W)
+		{
+			if (ev.key.action == Action::PRESS)
+				forwardKeyPressed = true;
+			else if (ev.key.action == Action::RELEASE)
+				forwardKeyPressed = false;
+		}
+		else if (ev.key.key == GLFW_KEY_S)
+		{
+			if (ev.key.action == Action::PRESS)
+				backwardKeyPressed = true;
+			else if (ev.key.action == Action::RELEASE)
+				backwardKeyPressed = false;
+		}
+		else if (ev.key.key == GLFW_KEY_A)
+		{
+			if (ev.key.action == Action::PRESS)
+				leftKeyPressed = true;
+			else if (ev.key.action == Action::RELEASE)
 				leftKeyPressed = false;
 		}
 		else if (ev.key.key == GLFW_KEY_D)
@@ -289,7 +1568,285 @@ void CornellScene::handleEvent(WindowEvent& ev,  GLfloat timedelta)
 		else if (ev.key.key == GLFW_KEY_C)
 		{
 			if (ev.key.action == Action::RELEASE)
-				cycleMode = (cycleMode + 1) % 6;
+			{
+				cycleMode = (cycleMode + 1) % 7;
+				temporalAccumulator->reset();
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_I)
+		{
+			if (ev.key.action == Action::RELEASE)
+				anisotropicVoxels = !anisotropicVoxels;
+		}
+		else if (ev.key.key == GLFW_KEY_V)
+		{
+			if (ev.key.action == Action::RELEASE)
+			{
+				atomicVoxelization = !atomicVoxelization;
+				geometryDirty = true;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_R)
+		{
+			// Cycle the voxel grid resolution between 64 and 512
+			if (ev.key.action == Action::RELEASE)
+			{
+				setVoxelGridSize(voxelGridSize >= 512 ? 64 : 2 * voxelGridSize);
+				std::cout << "Voxel grid size " << voxelGridSize << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_B)
+		{
+			// Toggle between a cubic grid and one following the aspect ratio of the scene bounds
+			if (ev.key.action == Action::RELEASE)
+			{
+				fitVoxelAspect = !fitVoxelAspect;
+				destroyVoxelGrid();
+				createVoxelGrid();
+				std::cout << "Voxel grid " << voxelGridDims.x << "x" << voxelGridDims.y << "x" << voxelGridDims.z << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_X)
+		{
+			// Cycle the voxelization paths, vertex pulling only where the driver supports it
+			if (ev.key.action == Action::RELEASE)
+			{
+				if (voxelizationPath == VOXELIZATION_PATH::GEOMETRY_SHADER)
+					voxelizationPath = VOXELIZATION_PATH::VIEWPORT_ARRAY;
+				else if (voxelizationPath == VOXELIZATION_PATH::VIEWPORT_ARRAY && shaders.count("VoxelizationPulled") != 0)
+					voxelizationPath = VOXELIZATION_PATH::VERTEX_PULLING;
+				else
+					voxelizationPath = VOXELIZATION_PATH::GEOMETRY_SHADER;
+				geometryDirty = true;
+				std::cout << "Voxelization path " << static_cast<int>(voxelizationPath) << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_H)
+		{
+			// Toggle compute voxelization of small triangles in front of the raster path
+			if (ev.key.action == Action::RELEASE && triangleVoxelizer != nullptr)
+			{
+				hybridVoxelization = !hybridVoxelization;
+				geometryDirty = true;
+				std::cout << (hybridVoxelization ? "Hybrid compute and raster voxelization" : "Raster voxelization") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_L)
+		{
+			// Cycle the frames of GI latency, each one adds a set of radiance volumes
+			if (ev.key.action == Action::RELEASE)
+			{
+				giLatency = (giLatency + 1) % 3;
+				destroyRadianceBuffers();
+				createRadianceBuffers();
+				std::cout << "GI latency " << giLatency << " frames" << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_K)
+		{
+			// Compare shader dilation against hardware conservative rasterization
+			if (ev.key.action == Action::RELEASE && hardwareConservativeRaster)
+			{
+				shaderDilation = !shaderDilation;
+				geometryDirty = true;
+				std::cout << (shaderDilation ? "Shader dilation" : "Hardware conservative rasterization") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_N)
+		{
+			// Cycle how many frames a full voxel update is spread over
+			if (ev.key.action == Action::RELEASE)
+			{
+				voxelUpdateDivisor = voxelUpdateDivisor >= 16 ? 1 : 2 * voxelUpdateDivisor;
+				voxelScheduler->setUpdateDivisor(voxelUpdateDivisor);
+				std::cout << "Voxel update spread over " << voxelScheduler->getUpdateDivisor() << " frame(s)" << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_G)
+		{
+			if (ev.key.action == Action::RELEASE)
+				computeMipmaps = !computeMipmaps;
+		}
+		else if (ev.key.key == GLFW_KEY_F)
+		{
+			// Switch between forward cone tracing per fragment and deferred cone tracing per pixel
+			if (ev.key.action == Action::RELEASE)
+			{
+				deferredShading = !deferredShading;
+				std::cout << (deferredShading ? "Deferred cone tracing" : "Forward cone tracing") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_1)
+		{
+			// Toggle the specular cone of the combined view
+			if (ev.key.action == Action::RELEASE)
+			{
+				specularCones = !specularCones;
+				std::cout << "Specular cones " << (specularCones ? "on" : "off") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_2)
+		{
+			// Toggle the shadow cone of the combined view
+			if (ev.key.action == Action::RELEASE)
+			{
+				shadowCones = !shadowCones;
+				std::cout << "Shadow cones " << (shadowCones ? "on" : "off") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_3)
+		{
+			// Cycle the quality tiers of the diffuse cone set
+			if (ev.key.action == Action::RELEASE)
+			{
+				const int* tier = std::find(std::begin(ConeSet::TIERS), std::end(ConeSet::TIERS), diffuseCones);
+				diffuseCones = tier + 1 < std::end(ConeSet::TIERS) ? *(tier + 1) : ConeSet::TIERS[0];
+				std::cout << diffuseCones << " diffuse cones, aperture " << ConeSet::getAperture(diffuseCones) << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_4)
+		{
+			// Cycle the hard limit on the steps of one cone
+			if (ev.key.action == Action::RELEASE)
+			{
+				maxConeSteps = maxConeSteps == 1024 ? 256 : maxConeSteps == 256 ? 64 : 1024;
+				std::cout << "At most " << maxConeSteps << " steps per cone" << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_5)
+		{
+			// Cycle the per-pixel step heatmap through off, steps of all cones, each quantity alone
+			if (ev.key.action == Action::RELEASE)
+			{
+				const int views[] = { -1, StepHeatmap::TOTAL_STEPS, StepHeatmap::DIFFUSE_STEPS, StepHeatmap::SPECULAR_STEPS,
+					StepHeatmap::SHADOW_STEPS, StepHeatmap::VOXEL_FETCHES };
+				const int* view = std::find(std::begin(views), std::end(views), heatmapView);
+				heatmapView = view + 1 < std::end(views) ? *(view + 1) : views[0];
+				if (heatmapView >= 0)
+					std::cout << "Step heatmap of " << StepHeatmap::getName(heatmapView) << ", statistics appended to stepHeatmap.csv" << std::endl;
+				else
+					std::cout << "Step heatmap off" << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_6)
+		{
+			// Toggle the sparse scene: without the box the objects float in a mostly empty volume, like outdoors
+			if (ev.key.action == Action::RELEASE)
+			{
+				sparseScene = !sparseScene;
+				if (sparseScene)
+					sceneObjs.erase("Box");
+				else
+					sceneObjs.emplace("Box", cornellBox);
+				destroyVoxelGrid();
+				createVoxelGrid();
+				temporalAccumulator->reset();
+				std::cout << (sparseScene ? "Sparse scene" : "Cornell box scene") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_7)
+		{
+			// Toggle the ambient occlusion of the shaded views, the occlusion view always traces it
+			if (ev.key.action == Action::RELEASE)
+			{
+				ambientOcclusion = !ambientOcclusion;
+				std::cout << "Ambient occlusion " << (ambientOcclusion ? "on" : "off") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_8)
+		{
+			// Cycle the resolution of the ambient occlusion cones through half, quarter and full
+			if (ev.key.action == Action::RELEASE)
+			{
+				occlusionScale = occlusionScale == 4 ? 1 : 2 * occlusionScale;
+				std::cout << "Ambient occlusion at 1/" << occlusionScale << " resolution" << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_U)
+		{
+			// Cycle the resolution of the indirect diffuse cones through full, half and quarter
+			if (ev.key.action == Action::RELEASE)
+			{
+				diffuseScale = diffuseScale == 4 ? 1 : 2 * diffuseScale;
+				std::cout << "Indirect diffuse at 1/" << diffuseScale << " resolution" << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_Y)
+		{
+			// Toggle accumulating indirect diffuse over frames, rotating the diffuse cone set
+			if (ev.key.action == Action::RELEASE)
+			{
+				temporalDiffuse = !temporalDiffuse;
+				temporalAccumulator->reset();
+				std::cout << "Temporal accumulation of indirect diffuse " << (temporalDiffuse ? "on" : "off") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_Q)
+		{
+			// Compare the reduced indirect diffuse against full resolution in the next frame
+			if (ev.key.action == Action::RELEASE)
+				measureDiffuse = true;
+		}
+		else if (ev.key.key == GLFW_KEY_Z)
+		{
+			// Toggle the depth pre-pass of the forward path
+			if (ev.key.action == Action::RELEASE)
+			{
+				depthPrepass = !depthPrepass;
+				std::cout << "Depth pre-pass " << (depthPrepass ? "on" : "off") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_O)
+		{
+			// Toggle lighting only the voxels the light sees through its cube shadow map
+			if (ev.key.action == Action::RELEASE && shadowMap != nullptr)
+			{
+				shadowMapInjection = !shadowMapInjection;
+				std::cout << (shadowMapInjection ? "Shadow map light injection" : "Per voxel light injection") << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_M)
+		{
+			// Cycle multi-bounce off or gathered over 1, 2, 4 or 8 frames
+			if (ev.key.action == Action::RELEASE)
+			{
+				bounceDivisor = bounceDivisor == 0 ? 1 : (bounceDivisor >= 8 ? 0 : 2 * bounceDivisor);
+				bouncePhase = 0;
+				if (bounceDivisor == 1)
+				{
+					GLfloat clearColor[4] = { 0, 0, 0, 0 };
+					voxelBounce->Clear(clearColor);
+				}
+				if (bounceDivisor == 0)
+					std::cout << "Multi-bounce off" << std::endl;
+				else
+					std::cout << "Multi-bounce gathered over " << bounceDivisor << " frames" << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_E)
+		{
+			// Cycle how cones skip empty space: distance field, occupancy pyramid where a texture unit is left, not at all
+			if (ev.key.action == Action::RELEASE)
+			{
+				if (emptySpaceSkipping == EMPTY_SPACE_SKIPPING::DISTANCE_FIELD)
+					emptySpaceSkipping = occupancyUnit >= 0 ? EMPTY_SPACE_SKIPPING::OCCUPANCY_PYRAMID : EMPTY_SPACE_SKIPPING::OFF;
+				else if (emptySpaceSkipping == EMPTY_SPACE_SKIPPING::OCCUPANCY_PYRAMID)
+					emptySpaceSkipping = EMPTY_SPACE_SKIPPING::OFF;
+				else
+					emptySpaceSkipping = EMPTY_SPACE_SKIPPING::DISTANCE_FIELD;
+				std::cout << "Cones march" << getEmptySpaceSkippingName() << std::endl;
+			}
+		}
+		else if (ev.key.key == GLFW_KEY_J)
+		{
+			// Check the jump flooded distance field of the traced buffer against the exact transform on the CPU
+			if (ev.key.action == Action::RELEASE)
+				distanceField->validate(*voxelAlbedo, *radianceBuffers[readBuffer].emptySpace, std::cout);
+		}
+		else if (ev.key.key == GLFW_KEY_T)
+		{
+			if (ev.key.action == Action::RELEASE)
+				printTimings = !printTimings;
 		}
 		else if (ev.key.key == GLFW_KEY_P)
 		{
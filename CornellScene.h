@@ -1,6 +1,66 @@
 #pragma once
 
 #include "GenericScene.h"
+#include "AnisotropicVoxelGrid.h"
+#include "Texture3DMipmapper.h"
+#include "TriangleVoxelizer.h"
+#include "CubeShadowMap.h"
+#include "GBuffer.h"
+#include "IndirectDiffuseBuffer.h"
+#include "AmbientOcclusionBuffer.h"
+#include "TemporalAccumulator.h"
+#include "ShaderPermutationCache.h"
+#include "ConeSet.h"
+#include "StepHeatmap.h"
+#include "GpuProfiler.h"
+#include "VoxelUpdateScheduler.h"
+#include "VoxelDistanceField.h"
+#include "VoxelOccupancyPyramid.h"
+#include "VoxelFormat.h"
+
+// How triangles are routed to the voxelization fragment shader
+enum class VOXELIZATION_PATH
+{
+	// Geometry shader swizzles into a square viewport of the largest grid dimension
+	GEOMETRY_SHADER,
+
+	// Geometry shader picks one of three viewports sized after the projection axis
+	VIEWPORT_ARRAY,
+
+	// Vertex shader pulls whole triangles and picks the viewport, needs ARB_shader_viewport_layer_array
+	VERTEX_PULLING
+};
+
+// How cones jump over voxels without geometry, the values are those of emptySpaceMode in the cone tracing shader
+enum class EMPTY_SPACE_SKIPPING
+{
+	OFF,
+
+	// Jumps by the distance to the nearest geometry, less the footprint of the farthest skipped sample
+	DISTANCE_FIELD,
+
+	// Jumps to the exit of the coarsest empty block of the occupancy pyramid the cone footprint fits in
+	OCCUPANCY_PYRAMID
+};
+
+// Lit voxel volumes sampled by the cone tracer
+struct RadianceBuffer
+{
+	Texture3D* grid;
+	Texture3D* opacity;
+	AnisotropicVoxelGrid* anisoGrid;
+
+	// Distance to the nearest geometry and the occupancy pyramid, rebuilt when the geometry changed since it was last built
+	Texture3D* emptySpace;
+	Texture3D* occupancy;
+	bool emptySpaceStale;
+
+	// Voxel layers relit in other buffers since this one was last written
+	std::vector<bool> staleLayers;
+
+	// Signalled once the GPU finished the last write to the buffer
+	GLsync written;
+};
 
 class CornellScene : public GenericScene
 {
@@ -13,9 +73,159 @@ public:
 	void drawScene() override;
 	void handleEvent(WindowEvent& ev, GLfloat timedelta) override;
 
+	// Reallocates all voxel volumes at the given resolution, they are voxelized again next frame
+	void setVoxelGridSize(int size);
+	int getVoxelGridSize() const;
+
 private:
+	// Fits the voxel volume to the union of the object bounds, sets the grid dimensions and transforms
+	void fitVoxelVolume();
+
+	// Allocates the voxel volumes and everything sized after them
+	void createVoxelGrid();
+	void destroyVoxelGrid();
+
+	// Allocates one radiance buffer per frame of GI latency plus the one being traced
+	void createRadianceBuffers();
+	void destroyRadianceBuffers();
+
+	// Picks the oldest buffer to write and the newest finished one to trace from
+	void selectRadianceBuffers();
+
+	// Voxel z ranges of a buffer that are out of date, clears its stale layers
+	std::vector<glm::ivec2> takeStaleRanges(RadianceBuffer& buffer);
+
+	// Maps a world space z interval to the voxel layers it touches
+	glm::ivec2 worldToVoxelLayers(GLfloat zMin, GLfloat zMax) const;
+
+	// Loads the static geometry volumes from disk, or voxelizes and stores them if no matching file exists
+	void loadVoxelCache();
+
+	// Marks the slabs of objects that moved since they were last voxelized
+	void markChangedGeometry();
+
+	// Rasterizes all objects into the albedo, normal and emissive volumes within the given voxel z ranges
+	void voxelizeGeometry(const std::vector<glm::ivec2>& ranges, bool includeDynamic = true);
+
+	// Lights the geometry volumes into a radiance buffer within the given voxel z ranges
+	void injectLight(RadianceBuffer& target, const std::vector<glm::ivec2>& ranges);
+
+	// Builds the parts of the mip chain used by the cone tracer covering the given voxel z ranges
+	void generateMipmaps(RadianceBuffer& target, const std::vector<glm::ivec2>& ranges);
+
+	// Cone traces the light reflected by a share of the voxels, added back at the next light injection
+	void gatherBounceLight(const RadianceBuffer& source);
+
+	// Renders the visible surface of every pixel and the material table for deferred cone tracing
+	void renderGBuffer();
+
+	// Draws all objects into the depth buffer only, with the current depth function
+	void drawDepthOnly();
+
+	// Binds the radiance buffer and uploads the uniforms shared by the cone tracing shaders
+	void bindConeTracingInputs(ShaderProgram& shader, const RadianceBuffer& source);
+
+	// Traces the indirect diffuse cones into the reduced resolution buffer and accumulates them over frames if enabled
+	void traceIndirectDiffuse(ShaderProgram& program, const RadianceBuffer& source);
+
+	// Whether the current view is shaded with ambient occlusion
+	bool usesAmbientOcclusion() const;
+
+	// Traces the ambient occlusion cones into the reduced resolution buffer
+	void traceAmbientOcclusion(ShaderProgram& program, const RadianceBuffer& source);
+
+	// How cones skip empty space, phrased to follow "Cones march" or a step count
+	const char* getEmptySpaceSkippingName() const;
+
+	// Defines of the cone tracing permutation for the current view and toggles
+	ShaderFeatures getConeTracingFeatures() const;
+
+	// Gets a permutation from a cache, printing the error and returning nullptr if it does not compile
+	ShaderProgram* getPermutation(ShaderPermutationCache& cache, const ShaderFeatures& features);
+
+	// Renders the scene with lighting cone traced from a radiance buffer
+	void traceCones(const RadianceBuffer& source);
+
+	// Traces the frame at full and at the reduced diffuse resolution, printing both times and the PSNR between them
+	void measureDiffuseQuality(const RadianceBuffer& source);
+
 	int voxelGridSize;
-	Texture3D* voxelGrid;
+	glm::ivec3 voxelGridDims;
+	bool fitVoxelAspect;
+	glm::mat4 worldToVoxel;
+	glm::mat4 voxelToWorld;
+	GLfloat voxelWorldSize;
+	VOXEL_FORMAT voxelFormat;
+	std::vector<RadianceBuffer> radianceBuffers;
+	int giLatency;
+	int writeBuffer;
+	int readBuffer;
+	int latestBuffer;
+	Texture3D* voxelAlbedo;
+	Texture3D* voxelNormal;
+	Texture3D* voxelEmissive;
+	Texture3D* voxelAmbient;
+	Texture3D* voxelBounce;
+	int bounceDivisor;
+	int bouncePhase;
+	bool geometryDirty;
+	std::map<std::string, glm::mat4> voxelizedTransforms;
+	VoxelUpdateScheduler* voxelScheduler;
+	VoxelDistanceField* distanceField;
+	VoxelOccupancyPyramid* occupancyPyramid;
+	GLint occupancyUnit;
+	EMPTY_SPACE_SKIPPING emptySpaceSkipping;
+	bool sparseScene;
+	SceneObject* cornellBox;
+	GLuint coneStepBuffer;
+	bool countConeSteps;
+	int maxConeSteps;
+	int voxelUpdateDivisor;
+	bool voxelCacheChecked;
+	bool anisotropicVoxels;
+	bool atomicVoxelization;
+	GLuint droppedWriteBuffer;
+	VOXELIZATION_PATH voxelizationPath;
+	bool hardwareConservativeRaster;
+	bool shaderDilation;
+	TriangleVoxelizer* triangleVoxelizer;
+	bool hybridVoxelization;
+	CubeShadowMap* shadowMap;
+	bool shadowMapInjection;
+	GBuffer* gBuffer;
+	bool deferredShading;
+	GLuint materialBuffer;
+	GLuint fullscreenVao;
+	GLuint fragmentQuery;
+	bool fragmentQueryPending;
+	bool fragmentQueryDeferred;
+	bool depthPrepass;
+	GLuint overdrawQueries[2];
+	bool overdrawQueryPending;
+	IndirectDiffuseBuffer* diffuseBuffer;
+	AmbientOcclusionBuffer* occlusionBuffer;
+	bool ambientOcclusion;
+	int occlusionScale;
+	int diffuseScale;
+	bool measureDiffuse;
+	TemporalAccumulator* temporalAccumulator;
+	bool temporalDiffuse;
+	std::map<std::string, glm::mat4> previousTransforms;
+	ShaderPermutationCache* coneTracingPrograms;
+	ShaderPermutationCache* indirectDiffusePrograms;
+	ShaderPermutationCache* ambientOcclusionPrograms;
+	ShaderPermutationCache* deferredConeTracingPrograms;
+	bool specularCones;
+	bool shadowCones;
+	ConeSet* coneSet;
+	int diffuseCones;
+	StepHeatmap* stepHeatmap;
+	int heatmapView;
+	Texture3DMipmapper* mipmapper;
+	bool computeMipmaps;
+	GpuProfiler profiler;
+	bool printTimings;
+	GLfloat lastTimingReport;
 	int cycleMode;
 
 };
@@ -0,0 +1,87 @@
+/**
+* @file	CubeShadowMap.cpp
+* @date	2026-10-19
+* @brief	Cube map of the surfaces a point light sees
+*/
+
+#include "CubeShadowMap.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+	// Looking direction and up vector of each face, in GL_TEXTURE_CUBE_MAP_POSITIVE_X + face order
+	const glm::vec3 faceDirections[6] = {
+		glm::vec3(1.f, 0.f, 0.f), glm::vec3(-1.f, 0.f, 0.f),
+		glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, -1.f, 0.f),
+		glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 0.f, -1.f)
+	};
+	const glm::vec3 faceUps[6] = {
+		glm::vec3(0.f, -1.f, 0.f), glm::vec3(0.f, -1.f, 0.f),
+		glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 0.f, -1.f),
+		glm::vec3(0.f, -1.f, 0.f), glm::vec3(0.f, -1.f, 0.f)
+	};
+}
+
+CubeShadowMap::CubeShadowMap(int _resolution) :
+	resolution{ _resolution }, positions{ 0 }, depth{ 0 }, framebuffer{ 0 },
+	shader{ "resc/shaders/shadowCubeVert.shader", "resc/shaders/shadowCubeFrag.shader" }
+{
+	shader.compile();
+	shader.link();
+
+	glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &positions);
+	glTextureStorage2D(positions, 1, GL_RGBA32F, resolution, resolution);
+	glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &depth);
+	glTextureStorage2D(depth, 1, GL_DEPTH_COMPONENT24, resolution, resolution);
+	glCreateFramebuffers(1, &framebuffer);
+}
+
+CubeShadowMap::~CubeShadowMap()
+{
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteTextures(1, &positions);
+	glDeleteTextures(1, &depth);
+}
+
+void CubeShadowMap::render(glm::vec3 lightPosition, const std::map<std::string, SceneObject*>& objects)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, resolution, resolution);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glEnable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_BLEND);
+
+	shader.use();
+	const glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, 0.01f, 100.f);
+	GLfloat clearPosition[4] = { 0.f, 0.f, 0.f, 0.f };
+	GLfloat clearDepth = 1.f;
+	for (int face = 0; face < 6; ++face)
+	{
+		glNamedFramebufferTextureLayer(framebuffer, GL_COLOR_ATTACHMENT0, positions, 0, face);
+		glNamedFramebufferTextureLayer(framebuffer, GL_DEPTH_ATTACHMENT, depth, 0, face);
+		glClearNamedFramebufferfv(framebuffer, GL_COLOR, 0, clearPosition);
+		glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &clearDepth);
+
+		const glm::mat4 viewProj = proj * glm::lookAt(lightPosition, lightPosition + faceDirections[face], faceUps[face]);
+		for (auto i : objects)
+		{
+			shader.uploadUniform("model", i.second->getModelTransform());
+			shader.uploadUniform("viewProj", viewProj);
+			i.second->draw();
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CubeShadowMap::bindImage(GLuint unit) const
+{
+	glBindImageTexture(unit, positions, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+}
+
+int CubeShadowMap::getResolution() const
+{
+	return resolution;
+}
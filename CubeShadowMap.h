@@ -0,0 +1,64 @@
+/**
+* @file	CubeShadowMap.h
+* @date	2026-10-19
+* @brief	Cube map of the surfaces a point light sees
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+
+#include "SceneObject.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Renders the scene from a point light into the six faces of a cube map.
+ *
+ * Every texel holds the world position of the nearest surface in that direction with
+ * alpha 1, or zeros where nothing was hit. Surface properties are looked up in the
+ * voxel volumes when the texels are injected, so positions are all the map stores.
+ */
+class CubeShadowMap
+{
+public:
+	CubeShadowMap() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param resolution Edge length of each face in texels.
+	 */
+	explicit CubeShadowMap(int resolution);
+
+	~CubeShadowMap();
+
+	CubeShadowMap(const CubeShadowMap&) = delete;
+	CubeShadowMap& operator=(const CubeShadowMap&) = delete;
+
+	/**
+	 * @brief Renders the objects as seen from a light. Leaves the default framebuffer bound.
+	 * @param lightPosition World position of the light.
+	 * @param objects Objects to render.
+	 */
+	void render(glm::vec3 lightPosition, const std::map<std::string, SceneObject*>& objects);
+
+	/**
+	 * @brief Binds the position cube map as a read only layered RGBA32F image.
+	 * @param unit Image unit.
+	 */
+	void bindImage(GLuint unit) const;
+
+	int getResolution() const;
+
+private:
+	int resolution;
+	GLuint positions;
+	GLuint depth;
+	GLuint framebuffer;
+	ShaderProgram shader;
+};
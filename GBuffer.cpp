@@ -0,0 +1,65 @@
+/**
+* @file	GBuffer.cpp
+* @date	2026-10-19
+* @brief	Render targets of the deferred cone tracing path
+*/
+
+#include "GBuffer.h"
+
+GBuffer::GBuffer(int _width, int _height) :
+	width{ _width }, height{ _height }, framebuffer{ 0 }, position{ 0 }, normal{ 0 }, color{ 0 }, depth{ 0 }
+{
+	glCreateTextures(GL_TEXTURE_2D, 1, &position);
+	glTextureStorage2D(position, 1, GL_RGBA32F, width, height);
+	glCreateTextures(GL_TEXTURE_2D, 1, &normal);
+	glTextureStorage2D(normal, 1, GL_RGBA16F, width, height);
+	glCreateTextures(GL_TEXTURE_2D, 1, &color);
+	glTextureStorage2D(color, 1, GL_RGBA8, width, height);
+	glCreateRenderbuffers(1, &depth);
+	glNamedRenderbufferStorage(depth, GL_DEPTH_COMPONENT24, width, height);
+
+	glCreateFramebuffers(1, &framebuffer);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, position, 0);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT1, normal, 0);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT2, color, 0);
+	glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	const GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glNamedFramebufferDrawBuffers(framebuffer, 3, drawBuffers);
+}
+
+GBuffer::~GBuffer()
+{
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteTextures(1, &position);
+	glDeleteTextures(1, &normal);
+	glDeleteTextures(1, &color);
+	glDeleteRenderbuffers(1, &depth);
+}
+
+void GBuffer::bindForWriting()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	GLfloat clearValue[4] = { 0.f, 0.f, 0.f, 0.f };
+	GLfloat clearDepth = 1.f;
+	for (GLint i = 0; i < 3; ++i)
+		glClearNamedFramebufferfv(framebuffer, GL_COLOR, i, clearValue);
+	glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &clearDepth);
+}
+
+void GBuffer::bindImages(GLuint firstUnit) const
+{
+	glBindImageTexture(firstUnit, position, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+	glBindImageTexture(firstUnit + 1, normal, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+	glBindImageTexture(firstUnit + 2, color, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+}
+
+int GBuffer::getWidth() const
+{
+	return width;
+}
+
+int GBuffer::getHeight() const
+{
+	return height;
+}
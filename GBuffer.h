@@ -0,0 +1,58 @@
+/**
+* @file	GBuffer.h
+* @date	2026-10-19
+* @brief	Render targets of the deferred cone tracing path
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+/**
+ * @brief Framebuffer holding the visible surface of every pixel.
+ *
+ * Attachments: world position with the material index in w (RGBA32F), world normal
+ * with coverage in w (RGBA16F), texture colour (RGBA8) and depth. Materials are
+ * looked up in a table by index instead of being stored per pixel.
+ */
+class GBuffer
+{
+public:
+	GBuffer() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param width Width in pixels.
+	 * @param height Height in pixels.
+	 */
+	GBuffer(int width, int height);
+
+	~GBuffer();
+
+	GBuffer(const GBuffer&) = delete;
+	GBuffer& operator=(const GBuffer&) = delete;
+
+	/**
+	 * @brief Binds the framebuffer and clears all attachments, coverage to 0.
+	 */
+	void bindForWriting();
+
+	/**
+	 * @brief Binds position, normal and colour as read only images to consecutive units.
+	 * @param firstUnit Image unit of the position attachment.
+	 */
+	void bindImages(GLuint firstUnit) const;
+
+	int getWidth() const;
+	int getHeight() const;
+
+private:
+	int width;
+	int height;
+	GLuint framebuffer;
+	GLuint position;
+	GLuint normal;
+	GLuint color;
+	GLuint depth;
+};
@@ -0,0 +1,90 @@
+/**
+* @file	GpuProfiler.cpp
+* @date	2026-10-19
+* @brief	GPU timer queries for named sections of a frame
+*/
+
+#include "GpuProfiler.h"
+
+#include <iomanip>
+
+GpuProfiler::~GpuProfiler()
+{
+	for (auto& i : sections)
+		glDeleteQueries(2 * FRAMES, &i.second.queries[0][0]);
+}
+
+void GpuProfiler::begin(const std::string& name)
+{
+	auto it = sections.find(name);
+	if (it == sections.end())
+	{
+		it = sections.emplace(name, Section{}).first;
+		glGenQueries(2 * FRAMES, &it->second.queries[0][0]);
+	}
+
+	glQueryCounter(it->second.queries[frame][0], GL_TIMESTAMP);
+}
+
+void GpuProfiler::end(const std::string& name)
+{
+	Section& section = sections.at(name);
+	glQueryCounter(section.queries[frame][1], GL_TIMESTAMP);
+	section.pending[frame] = true;
+}
+
+void GpuProfiler::endFrame()
+{
+	frame = (frame + 1) % FRAMES;
+
+	// The slot about to be reused was issued FRAMES - 1 frames ago and is normally done.
+	// If it is not, the sample is dropped rather than waited for
+	for (auto& i : sections)
+	{
+		Section& section = i.second;
+		if (!section.pending[frame])
+			continue;
+
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(section.queries[frame][1], GL_QUERY_RESULT_AVAILABLE, &available);
+		section.pending[frame] = false;
+		if (available == GL_FALSE)
+		{
+			++section.skipped;
+			continue;
+		}
+
+		GLuint64 start, stop;
+		glGetQueryObjectui64v(section.queries[frame][0], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(section.queries[frame][1], GL_QUERY_RESULT, &stop);
+
+		section.lastMs = (stop - start) / 1.0e6;
+		section.accumulatedMs += section.lastMs;
+		++section.samples;
+	}
+}
+
+double GpuProfiler::getMilliseconds(const std::string& name) const
+{
+	auto it = sections.find(name);
+	return it == sections.end() ? 0.0 : it->second.lastMs;
+}
+
+void GpuProfiler::report(std::ostream& os)
+{
+	for (auto& i : sections)
+	{
+		Section& section = i.second;
+		if (section.samples == 0 && section.skipped == 0)
+			continue;
+
+		os << std::setw(24) << std::left << i.first << std::fixed << std::setprecision(3)
+			<< (section.samples > 0 ? section.accumulatedMs / section.samples : 0.0) << " ms";
+		if (section.skipped > 0)
+			os << " (" << section.skipped << " samples skipped)";
+		os << std::endl;
+		section.accumulatedMs = 0.0;
+		section.samples = 0;
+		section.skipped = 0;
+	}
+}
@@ -0,0 +1,77 @@
+/**
+* @file	GpuProfiler.h
+* @date	2026-10-19
+* @brief	GPU timer queries for named sections of a frame
+*/
+
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+/**
+ * @brief Measures GPU time of named sections with timestamp queries.
+ *
+ * Queries are kept in a ring of frames so results are read back a few frames
+ * late instead of stalling the pipeline. Each section may be measured once per frame.
+ */
+class GpuProfiler
+{
+public:
+	GpuProfiler() = default;
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	/**
+	 * @brief Starts timing a section.
+	 * @param name Name of the section.
+	 */
+	void begin(const std::string& name);
+
+	/**
+	 * @brief Stops timing a section.
+	 * @param name Name of the section.
+	 */
+	void end(const std::string& name);
+
+	/**
+	 * @brief Collects finished queries and advances to the next frame.
+	 */
+	void endFrame();
+
+	/**
+	 * @brief Gets the latest measured time of a section.
+	 * @param name Name of the section.
+	 * @return Time in milliseconds, 0 if nothing has been measured yet.
+	 */
+	double getMilliseconds(const std::string& name) const;
+
+	/**
+	 * @brief Writes the average time of each section since the last report and resets the averages.
+	 * Samples whose queries were not done when their slot came round again are counted as skipped.
+	 * @param os Stream to write to.
+	 */
+	void report(std::ostream& os);
+
+private:
+	static const int FRAMES = 4;
+
+	struct Section
+	{
+		GLuint queries[FRAMES][2]{};
+		bool pending[FRAMES]{};
+		double lastMs{ 0.0 };
+		double accumulatedMs{ 0.0 };
+		int samples{ 0 };
+		int skipped{ 0 };
+	};
+
+	std::map<std::string, Section> sections{};
+	int frame{ 0 };
+};
@@ -0,0 +1,83 @@
+/**
+* @file	IndirectDiffuseBuffer.cpp
+* @date	2026-10-19
+* @brief	Reduced resolution render target of the indirect diffuse cones
+*/
+
+#include "IndirectDiffuseBuffer.h"
+
+IndirectDiffuseBuffer::IndirectDiffuseBuffer(int _windowWidth, int _windowHeight, int _scale) :
+	windowWidth{ _windowWidth }, windowHeight{ _windowHeight }, scale{ _scale },
+	width{ (_windowWidth + _scale - 1) / _scale }, height{ (_windowHeight + _scale - 1) / _scale },
+	framebuffer{ 0 }, irradiance{ 0 }, surface{ 0 }, motion{ 0 }, depth{ 0 }
+{
+	glCreateTextures(GL_TEXTURE_2D, 1, &irradiance);
+	glTextureStorage2D(irradiance, 1, GL_RGBA16F, width, height);
+	glCreateTextures(GL_TEXTURE_2D, 1, &surface);
+	glTextureStorage2D(surface, 1, GL_RGBA32F, width, height);
+	glCreateTextures(GL_TEXTURE_2D, 1, &motion);
+	glTextureStorage2D(motion, 1, GL_RGBA32F, width, height);
+	glCreateRenderbuffers(1, &depth);
+	glNamedRenderbufferStorage(depth, GL_DEPTH_COMPONENT24, width, height);
+
+	glCreateFramebuffers(1, &framebuffer);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, irradiance, 0);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT1, surface, 0);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT2, motion, 0);
+	glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	const GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glNamedFramebufferDrawBuffers(framebuffer, 3, drawBuffers);
+}
+
+IndirectDiffuseBuffer::~IndirectDiffuseBuffer()
+{
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteTextures(1, &irradiance);
+	glDeleteTextures(1, &surface);
+	glDeleteTextures(1, &motion);
+	glDeleteRenderbuffers(1, &depth);
+}
+
+void IndirectDiffuseBuffer::bindForWriting()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, width, height);
+
+	GLfloat clearValue[4] = { 0.f, 0.f, 0.f, 0.f };
+	GLfloat clearDepth = 1.f;
+	for (GLint i = 0; i < 3; ++i)
+		glClearNamedFramebufferfv(framebuffer, GL_COLOR, i, clearValue);
+	glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &clearDepth);
+}
+
+void IndirectDiffuseBuffer::bindImages(GLuint firstUnit) const
+{
+	glBindImageTexture(firstUnit, irradiance, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+	glBindImageTexture(firstUnit + 1, surface, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+	glBindImageTexture(firstUnit + 2, motion, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+}
+
+int IndirectDiffuseBuffer::getWindowWidth() const
+{
+	return windowWidth;
+}
+
+int IndirectDiffuseBuffer::getWindowHeight() const
+{
+	return windowHeight;
+}
+
+int IndirectDiffuseBuffer::getScale() const
+{
+	return scale;
+}
+
+int IndirectDiffuseBuffer::getWidth() const
+{
+	return width;
+}
+
+int IndirectDiffuseBuffer::getHeight() const
+{
+	return height;
+}
@@ -0,0 +1,67 @@
+/**
+* @file	IndirectDiffuseBuffer.h
+* @date	2026-10-19
+* @brief	Reduced resolution render target of the indirect diffuse cones
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+/**
+ * @brief Framebuffer holding indirect diffuse irradiance at a fraction of the window resolution.
+ *
+ * Attachments: irradiance without the surface albedo (RGBA16F), the surface it was traced from
+ * as world normal and distance to the camera (RGBA32F, 0 where nothing was hit), its motion
+ * (RGBA32F, screen position change since the previous frame in xy, linear depth in the previous
+ * and the current frame in zw) and depth. The full resolution pass upsamples the irradiance
+ * guided by the surface attachment, temporal accumulation reprojects it with the motion.
+ */
+class IndirectDiffuseBuffer
+{
+public:
+	IndirectDiffuseBuffer() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param windowWidth Width of the window in pixels.
+	 * @param windowHeight Height of the window in pixels.
+	 * @param scale Window pixels per buffer pixel along each axis.
+	 */
+	IndirectDiffuseBuffer(int windowWidth, int windowHeight, int scale);
+
+	~IndirectDiffuseBuffer();
+
+	IndirectDiffuseBuffer(const IndirectDiffuseBuffer&) = delete;
+	IndirectDiffuseBuffer& operator=(const IndirectDiffuseBuffer&) = delete;
+
+	/**
+	 * @brief Binds the framebuffer, sets the viewport to its size and clears all attachments.
+	 */
+	void bindForWriting();
+
+	/**
+	 * @brief Binds irradiance, surface and motion as read only images to consecutive units.
+	 * @param firstUnit Image unit of the irradiance attachment.
+	 */
+	void bindImages(GLuint firstUnit) const;
+
+	int getWindowWidth() const;
+	int getWindowHeight() const;
+	int getScale() const;
+	int getWidth() const;
+	int getHeight() const;
+
+private:
+	int windowWidth;
+	int windowHeight;
+	int scale;
+	int width;
+	int height;
+	GLuint framebuffer;
+	GLuint irradiance;
+	GLuint surface;
+	GLuint motion;
+	GLuint depth;
+};
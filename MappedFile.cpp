@@ -0,0 +1,101 @@
+/**
+* @file	MappedFile.cpp
+* @date	2026-10-19
+* @brief	Read only memory mapped file
+*/
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) :
+	mapping{ nullptr },
+	length{ 0 },
+	fileHandle{ INVALID_HANDLE_VALUE },
+	mappingHandle{ nullptr }
+{
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+		return;
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle == nullptr)
+		return;
+
+	mapping = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (mapping != nullptr)
+		length = static_cast<std::size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	if (mapping != nullptr)
+		UnmapViewOfFile(mapping);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) :
+	mapping{ nullptr },
+	length{ 0 },
+	fileDescriptor{ -1 }
+{
+	fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+		return;
+
+	struct stat info;
+	if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0)
+		return;
+
+	void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (view == MAP_FAILED)
+		return;
+
+	mapping = static_cast<const unsigned char*>(view);
+	length = static_cast<std::size_t>(info.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+	if (mapping != nullptr)
+		munmap(const_cast<unsigned char*>(mapping), length);
+	if (fileDescriptor >= 0)
+		close(fileDescriptor);
+}
+
+#endif
+
+bool MappedFile::isOpen() const
+{
+	return mapping != nullptr;
+}
+
+const unsigned char* MappedFile::data() const
+{
+	return mapping;
+}
+
+std::size_t MappedFile::size() const
+{
+	return length;
+}
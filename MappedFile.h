@@ -0,0 +1,58 @@
+/**
+* @file	MappedFile.h
+* @date	2026-10-19
+* @brief	Read only memory mapped file
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Maps a whole file read only into memory.
+ *
+ * The mapping is released when the object is destroyed.
+ */
+class MappedFile
+{
+public:
+	MappedFile() = delete;
+
+	/**
+	 * @brief Constructor. Maps the file if it exists.
+	 * @param path File path.
+	 */
+	explicit MappedFile(const std::string& path);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * @brief Whether the file was opened and mapped.
+	 */
+	bool isOpen() const;
+
+	/**
+	 * @brief Start of the mapped file, nullptr if not open.
+	 */
+	const unsigned char* data() const;
+
+	/**
+	 * @brief Size of the mapped file in bytes.
+	 */
+	std::size_t size() const;
+
+private:
+	const unsigned char* mapping;
+	std::size_t length;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
@@ -8,6 +8,7 @@
 #include "RawModel.h"
 
 #include "loadobj.h"
+#include "Utils.h"
 
 RawModel::RawModel(const char* fileName)
 {
@@ -15,6 +16,23 @@ RawModel::RawModel(const char* fileName)
 
 	m = LoadModel(const_cast<char*>(fileName));
 
+	if (m->numVertices > 0)
+	{
+		boundsMin = boundsMax = glm::vec3(m->vertexArray[0], m->vertexArray[1], m->vertexArray[2]);
+		for (int i = 1; i < m->numVertices; ++i)
+		{
+			const glm::vec3 vertex(m->vertexArray[3 * i], m->vertexArray[3 * i + 1], m->vertexArray[3 * i + 2]);
+			boundsMin = glm::min(boundsMin, vertex);
+			boundsMax = glm::max(boundsMax, vertex);
+		}
+	}
+
+	contentHash = hashBytes(m->vertexArray, m->numVertices * 3 * sizeof(GLfloat));
+	contentHash = hashBytes(m->normalArray, m->numVertices * 3 * sizeof(GLfloat), contentHash);
+	if (m->texCoordArray != nullptr)
+		contentHash = hashBytes(m->texCoordArray, m->numVertices * 2 * sizeof(GLfloat), contentHash);
+	contentHash = hashBytes(m->indexArray, m->numIndices * sizeof(GLuint), contentHash);
+
 	vao.bind();
 
 	vertexPositions.storeData(m->numVertices * 3 * sizeof(GLfloat), m->vertexArray, GL_STATIC_DRAW);
@@ -27,6 +45,7 @@ RawModel::RawModel(const char* fileName)
 	{
 		textureCoordinates.storeData(m->numVertices * 2 * sizeof(GLfloat), m->texCoordArray, GL_STATIC_DRAW);
 		textureCoordinates.setupVertexAttribPointer(2, 2);
+		texCoordsPresent = true;
 	}
 
 	indexBuffer.storeData(m->numIndices * sizeof(GLuint), m->indexArray, GL_STATIC_DRAW);
@@ -40,11 +59,79 @@ void RawModel::draw()
 {
 	vao.bind();
 	indexBuffer.bind();
-	glDrawElements(GL_TRIANGLES, indexBuffer.getSize() / sizeof(GLuint), GL_UNSIGNED_INT, 0L);
+	glDrawElements(GL_TRIANGLES, getIndexCount(), GL_UNSIGNED_INT, 0L);
 	indexBuffer.unbind();
 	vao.unbind();
 }
 
+glm::vec3 RawModel::getBoundsMin() const
+{
+	return boundsMin;
+}
+
+glm::vec3 RawModel::getBoundsMax() const
+{
+	return boundsMax;
+}
+
+void RawModel::drawVertexPulling()
+{
+	bindStorageBuffers();
+
+	// The VAO only satisfies the core profile, no attributes are read
+	vao.bind();
+	glDrawArrays(GL_TRIANGLES, 0, getIndexCount());
+	vao.unbind();
+}
+
+void RawModel::bindStorageBuffers()
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vertexPositions.getHandle());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, vertexNormals.getHandle());
+	if (texCoordsPresent)
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, textureCoordinates.getHandle());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, indexBuffer.getHandle());
+}
+
+void RawModel::drawIndirect(GLuint elementBuffer, GLuint commandBuffer)
+{
+	// The element binding is VAO state, draw() binds the model indices again
+	vao.bind();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0L);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	vao.unbind();
+}
+
+void RawModel::drawVertexPullingIndirect(GLuint elementBuffer, GLuint commandBuffer)
+{
+	bindStorageBuffers();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, elementBuffer);
+
+	vao.bind();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glDrawArraysIndirect(GL_TRIANGLES, 0L);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	vao.unbind();
+}
+
+GLuint RawModel::getIndexCount() const
+{
+	return indexBuffer.getSize() / sizeof(GLuint);
+}
+
+bool RawModel::hasTextureCoordinates() const
+{
+	return texCoordsPresent;
+}
+
+std::uint64_t RawModel::getContentHash() const
+{
+	return contentHash;
+}
+
 RawModel::~RawModel()
 {
 	// Do nothing
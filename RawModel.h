@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
@@ -39,8 +41,80 @@ public:
 	 * @brief Destructor.
 	 */
 	virtual ~RawModel();
+
+	/**
+	 * @brief Gets the minimum corner of the model space bounding box.
+	 * @return Minimum corner.
+	 */
+	glm::vec3 getBoundsMin() const;
+
+	/**
+	 * @brief Gets the maximum corner of the model space bounding box.
+	 * @return Maximum corner.
+	 */
+	glm::vec3 getBoundsMax() const;
+
+	/**
+	 * @brief Gets a hash of the vertex and index data.
+	 * @return Hash value.
+	 */
+	std::uint64_t getContentHash() const;
+
+	/**
+	 * @brief Draws the model without vertex attributes for shaders doing vertex pulling.
+	 *
+	 * Positions, normals, texture coordinates and indices are bound as shader storage
+	 * buffers 0-3 and one vertex is drawn per index.
+	 */
+	void drawVertexPulling();
+
+	/**
+	 * @brief Binds positions, normals, texture coordinates and indices as shader storage buffers 0-3.
+	 */
+	void bindStorageBuffers();
+
+	/**
+	 * @brief Draws a subset of the triangles listed in another index buffer.
+	 * @param elementBuffer Buffer of vertex indices into this model.
+	 * @param commandBuffer Buffer holding a DrawElementsIndirectCommand for elementBuffer.
+	 */
+	void drawIndirect(GLuint elementBuffer, GLuint commandBuffer);
+
+	/**
+	 * @brief Draws a subset of the triangles listed in another index buffer with vertex pulling.
+	 * @param elementBuffer Buffer of vertex indices into this model, bound in place of the model indices.
+	 * @param commandBuffer Buffer holding a DrawArraysIndirectCommand, the first four values
+	 *        of a DrawElementsIndirectCommand with zero offsets serve as well.
+	 */
+	void drawVertexPullingIndirect(GLuint elementBuffer, GLuint commandBuffer);
+
+	/**
+	 * @brief Gets the number of vertex indices, three per triangle.
+	 */
+	GLuint getIndexCount() const;
+
+	/**
+	 * @brief Whether the model file had texture coordinates.
+	 */
+	bool hasTextureCoordinates() const;
 protected:
 
+	/**
+	 * @brief Model space bounding box
+	 */
+	glm::vec3 boundsMin{ 0.f };
+	glm::vec3 boundsMax{ 0.f };
+
+	/**
+	 * @brief Hash of the vertex and index data
+	 */
+	std::uint64_t contentHash{ 0 };
+
+	/**
+	 * @brief Whether the texture coordinate VBO holds data
+	 */
+	bool texCoordsPresent{ false };
+
 	/**
 	 * @brief Model VAO
 	 */
@@ -6,12 +6,19 @@
 */
 
 #include "SceneObject.h"
+#include "Utils.h"
+
+#include <limits>
 
 SceneObject::SceneObject(const char* path) : 
 	tr{},
 	mo{path},
 	mat{ glm::vec3(0,0,0), glm::vec3(0,0,0), glm::vec3(0,0,0), 0 },
-	tex{}
+	tex{},
+	dynamic{false},
+	hasMotionBounds{false},
+	motionMin{0.f},
+	motionMax{0.f}
 {
 }
 
@@ -25,6 +32,21 @@ void SceneObject::draw()
 	mo.draw();
 }
 
+void SceneObject::drawVertexPulling()
+{
+	mo.drawVertexPulling();
+}
+
+bool SceneObject::hasTextureCoordinates() const
+{
+	return mo.hasTextureCoordinates();
+}
+
+RawModel& SceneObject::getModel()
+{
+	return mo;
+}
+
 TransformPipeline3D* SceneObject::getTransform()
 {
 	return &tr;
@@ -82,3 +104,68 @@ glm::mat4 SceneObject::getMVP() const
 {
 	return tr.getMVP();
 }
+
+void SceneObject::getWorldBounds(glm::vec3& min, glm::vec3& max) const
+{
+	getWorldBounds(getModelTransform(), min, max);
+}
+
+void SceneObject::getWorldBounds(const glm::mat4& model, glm::vec3& min, glm::vec3& max) const
+{
+	// Bounding box of the transformed corners of the model space box
+	const glm::vec3 corners[2] = { mo.getBoundsMin(), mo.getBoundsMax() };
+	min = glm::vec3(std::numeric_limits<float>::max());
+	max = glm::vec3(-std::numeric_limits<float>::max());
+	for (int i = 0; i < 8; ++i)
+	{
+		const glm::vec3 corner(corners[i & 1].x, corners[(i >> 1) & 1].y, corners[(i >> 2) & 1].z);
+		const glm::vec3 world = glm::vec3(model * glm::vec4(corner, 1.f));
+		min = glm::min(min, world);
+		max = glm::max(max, world);
+	}
+}
+
+void SceneObject::setDynamic(bool dynamic)
+{
+	this->dynamic = dynamic;
+}
+
+std::uint64_t SceneObject::getVoxelHash(std::uint64_t seed) const
+{
+	// Everything that ends up in the geometry volumes
+	const glm::mat4 model = getModelTransform();
+	const float material[] = {
+		mat.getAmbient().r, mat.getAmbient().g, mat.getAmbient().b,
+		mat.getDiffuse().r, mat.getDiffuse().g, mat.getDiffuse().b,
+		mat.getEmissivity(), mat.getDiffuseReflectivity(), mat.getSpecularReflectivity()
+	};
+	const std::uint64_t meshHash = mo.getContentHash();
+
+	seed = hashBytes(&meshHash, sizeof(meshHash), seed);
+	seed = hashBytes(&model[0][0], sizeof(model), seed);
+	seed = hashBytes(material, sizeof(material), seed);
+	return hashBytes(tex.data(), tex.size(), seed);
+}
+
+bool SceneObject::isDynamic() const
+{
+	return dynamic;
+}
+
+void SceneObject::setMotionBounds(glm::vec3 min, glm::vec3 max)
+{
+	hasMotionBounds = true;
+	motionMin = min;
+	motionMax = max;
+}
+
+void SceneObject::getMotionBounds(glm::vec3& min, glm::vec3& max) const
+{
+	if (!hasMotionBounds)
+	{
+		getWorldBounds(min, max);
+		return;
+	}
+	min = motionMin;
+	max = motionMax;
+}
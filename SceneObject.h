@@ -10,6 +10,9 @@ public:
 	~SceneObject();
 
 	void draw();
+	void drawVertexPulling();
+	bool hasTextureCoordinates() const;
+	RawModel& getModel();
 
 	TransformPipeline3D* getTransform();
 
@@ -25,12 +28,24 @@ public:
 	glm::mat4 getModelTransform() const;
 	glm::mat4 getLocalModelTransform() const;
 	glm::mat4 getMVP() const;
+	void getWorldBounds(glm::vec3& min, glm::vec3& max) const;
+	void getWorldBounds(const glm::mat4& model, glm::vec3& min, glm::vec3& max) const;
+	void setDynamic(bool dynamic);
+	bool isDynamic() const;
+	// World box a dynamic object stays within while it moves, its current bounds until set
+	void setMotionBounds(glm::vec3 min, glm::vec3 max);
+	void getMotionBounds(glm::vec3& min, glm::vec3& max) const;
+	std::uint64_t getVoxelHash(std::uint64_t seed) const;
 
 	Material mat;
 private:
 	TransformPipeline3D tr;
 	RawModel mo;
 	std::string tex;
+	bool dynamic;
+	bool hasMotionBounds;
+	glm::vec3 motionMin;
+	glm::vec3 motionMax;
 
 };
 
@@ -0,0 +1,67 @@
+/**
+* @file	ShaderPermutationCache.cpp
+* @date	2026-10-19
+* @brief	Specialized variants of a shader program compiled on demand
+*/
+
+#include "ShaderPermutationCache.h"
+
+#include <iostream>
+
+ShaderPermutationCache::ShaderPermutationCache(const std::string& _name, std::function<ShaderProgram*()> _create) :
+	name{ _name }, create{ _create }, programs{}
+{
+}
+
+ShaderPermutationCache::~ShaderPermutationCache()
+{
+	for (auto i : programs)
+		delete i.second;
+}
+
+ShaderProgram& ShaderPermutationCache::get(const ShaderFeatures& features)
+{
+	const std::string key = getKey(features);
+	auto it = programs.find(key);
+	if (it != programs.end())
+		return *it->second;
+
+	ShaderProgram* program = create();
+	for (const auto& feature : features)
+		program->addDefine(feature.first, feature.second);
+	try
+	{
+		program->compile();
+		program->link();
+	}
+	catch (const ShaderProgramException&)
+	{
+		delete program;
+		throw;
+	}
+
+	// Register usage is not exposed by OpenGL, the binary size is the portable hint of how much a path costs
+	GLint binaryLength = 0;
+	glGetProgramiv(program->getShaderProgramHandle(), GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	std::cout << "Compiled " << name << " [" << key << "]: " << binaryLength << " bytes of program binary" << std::endl;
+
+	programs.emplace(key, program);
+	return *program;
+}
+
+std::string ShaderPermutationCache::getKey(const ShaderFeatures& features)
+{
+	std::string key;
+	for (const auto& feature : features)
+	{
+		if (!key.empty())
+			key += " ";
+		key += feature.second.empty() ? feature.first : feature.first + "=" + feature.second;
+	}
+	return key;
+}
+
+std::size_t ShaderPermutationCache::size() const
+{
+	return programs.size();
+}
@@ -0,0 +1,69 @@
+/**
+* @file	ShaderPermutationCache.h
+* @date	2026-10-19
+* @brief	Specialized variants of a shader program compiled on demand
+*/
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ShaderProgram.h"
+
+/**
+ * @brief Preprocessor defines selecting one permutation, in a fixed order per cache
+ */
+using ShaderFeatures = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Compiles a program once per feature set and keeps it.
+ *
+ * Features are passed as preprocessor defines, so each permutation is compiled with the paths
+ * it does not use removed instead of branching on uniforms. Vertex inputs need explicit
+ * locations in the shader, attribute locations are not bound.
+ */
+class ShaderPermutationCache
+{
+public:
+	ShaderPermutationCache() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param name Name used in messages.
+	 * @param create Creates an uncompiled program with the shader paths and the defines shared by all permutations.
+	 */
+	ShaderPermutationCache(const std::string& name, std::function<ShaderProgram*()> create);
+
+	~ShaderPermutationCache();
+
+	ShaderPermutationCache(const ShaderPermutationCache&) = delete;
+	ShaderPermutationCache& operator=(const ShaderPermutationCache&) = delete;
+
+	/**
+	 * @brief Gets the program of a feature set, compiling and linking it on first use.
+	 * @param features Defines of the permutation.
+	 * @return Linked program, owned by the cache.
+	 * @throws ShaderProgramException if the permutation fails to compile.
+	 */
+	ShaderProgram& get(const ShaderFeatures& features);
+
+	/**
+	 * @brief Gets the key of a feature set, as used in messages and timings.
+	 * @param features Defines of the permutation.
+	 */
+	static std::string getKey(const ShaderFeatures& features);
+
+	/**
+	 * @brief Gets the number of permutations compiled so far.
+	 */
+	std::size_t size() const;
+
+private:
+	std::string name;
+	std::function<ShaderProgram*()> create;
+	std::map<std::string, ShaderProgram*> programs;
+};
@@ -13,6 +13,10 @@ ShaderProgram::ShaderProgram(const std::string& vertexShaderPath, const std::str
 	:vertexShaderPath(vertexShaderPath), fragmentShaderPath(fragmentShaderPath), geometryShaderPath(geometryShaderPath)
 {}
 
+ShaderProgram::ShaderProgram(const std::string& computeShaderPath)
+	:computeShaderPath(computeShaderPath), shaderProgramHandle(0), vertexShaderHandle(0), fragmentShaderHandle(0), geometryShaderHandle(0)
+{}
+
 ShaderProgram::~ShaderProgram()
 {
 	if (glIsProgram(shaderProgramHandle))
@@ -34,6 +38,11 @@ ShaderProgram::~ShaderProgram()
 	{
 		glDeleteShader(geometryShaderHandle);
 	}
+
+	if (glIsShader(computeShaderHandle))
+	{
+		glDeleteShader(computeShaderHandle);
+	}
 }
 
 void ShaderProgram::compile()
@@ -53,16 +62,51 @@ void ShaderProgram::compile()
 		glDeleteShader(geometryShaderHandle);
 	}
 
+	if (glIsShader(computeShaderHandle))
+	{
+		glDeleteShader(computeShaderHandle);
+	}
+
+	GLint success;
+	GLchar infoLog[512];
+
+	// Compute programs consist of a single compute shader stage
+	if (computeShaderPath != "")
+	{
+		computeShaderHandle = glCreateShader(GL_COMPUTE_SHADER);
+
+		std::string computeShaderString = loadSource(computeShaderPath);
+		const char* computeShaderSource = computeShaderString.c_str();
+		glShaderSource(computeShaderHandle, 1, &computeShaderSource, NULL);
+		glCompileShader(computeShaderHandle);
+
+		glGetShaderiv(computeShaderHandle, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(computeShaderHandle, 512, NULL, infoLog);
+			std::string errorMessage;
+			errorMessage = "Error compiling compute shader (" + computeShaderPath + ")\n" + infoLog;
+			throw ShaderProgramException(errorMessage);
+		}
+
+		if (glIsProgram(shaderProgramHandle))
+		{
+			glDeleteProgram(shaderProgramHandle);
+		}
+
+		shaderProgramHandle = glCreateProgram();
+		glAttachShader(shaderProgramHandle, computeShaderHandle);
+		return;
+	}
+
 	// Create a new vertex shader
 	vertexShaderHandle = glCreateShader(GL_VERTEX_SHADER);
 
-	std::string vertexShaderString = getStringFromFile(vertexShaderPath);
+	std::string vertexShaderString = loadSource(vertexShaderPath);
 	const char* vertexShaderSource = vertexShaderString.c_str();
 	glShaderSource(vertexShaderHandle, 1, &vertexShaderSource, NULL);
 	glCompileShader(vertexShaderHandle);
 
-	GLint success;
-	GLchar infoLog[512];
 	glGetShaderiv(vertexShaderHandle, GL_COMPILE_STATUS, &success);
 	if (!success)
 	{
@@ -74,7 +118,7 @@ void ShaderProgram::compile()
 
 	fragmentShaderHandle = glCreateShader(GL_FRAGMENT_SHADER);
 
-	std::string fragmentShaderString = getStringFromFile(fragmentShaderPath);
+	std::string fragmentShaderString = loadSource(fragmentShaderPath);
 	const char* fragmentShaderSource = fragmentShaderString.c_str();
 	glShaderSource(fragmentShaderHandle, 1, &fragmentShaderSource, NULL);
 	glCompileShader(fragmentShaderHandle);
@@ -92,7 +136,7 @@ void ShaderProgram::compile()
 	{
 		geometryShaderHandle = glCreateShader(GL_GEOMETRY_SHADER);
 
-		std::string geometryShaderString = getStringFromFile(geometryShaderPath);
+		std::string geometryShaderString = loadSource(geometryShaderPath);
 		const char* geometryShaderSource = geometryShaderString.c_str();
 
 		glShaderSource(geometryShaderHandle, 1, &geometryShaderSource, NULL);
@@ -126,6 +170,26 @@ void ShaderProgram::compile()
 
 }
 
+void ShaderProgram::addDefine(const std::string& name, const std::string& value)
+{
+	defines += "#define " + name + " " + value + "\n";
+}
+
+std::string ShaderProgram::loadSource(const std::string& path) const
+{
+	std::string source = getStringFromFile(path);
+	if (defines.empty())
+		return source;
+
+	// Defines have to follow the #version directive
+	const std::size_t version = source.find("#version");
+	const std::size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+	if (lineEnd == std::string::npos)
+		return defines + source;
+
+	return source.insert(lineEnd + 1, defines);
+}
+
 void ShaderProgram::link() const
 {
 	GLint success;
@@ -137,7 +201,7 @@ void ShaderProgram::link() const
 	if (!success) {
 		glGetProgramInfoLog(shaderProgramHandle, 512, NULL, infoLog);
 		std::string errorMessage;
-		errorMessage = std::string{ "Error linking shader program " } + vertexShaderPath + "\n" + std::string{ infoLog };
+		errorMessage = std::string{ "Error linking shader program " } + (computeShaderPath != "" ? computeShaderPath : vertexShaderPath) + "\n" + std::string{ infoLog };
 		throw ShaderProgramException(errorMessage);
 	}
 }
@@ -157,6 +221,12 @@ void ShaderProgram::disable() const
 	glUseProgram(0);
 }
 
+void ShaderProgram::dispatch(GLuint groupsX, GLuint groupsY, GLuint groupsZ) const
+{
+	use();
+	glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
 GLuint ShaderProgram::getShaderProgramHandle() const
 {
 	return shaderProgramHandle;
@@ -192,6 +262,18 @@ void ShaderProgram::uploadUniform(const std::string& name, glm::vec4 value)
 	glUniform4f(glGetUniformLocation(shaderProgramHandle, name.c_str()), value.x, value.y, value.z, value.w);
 }
 
+void ShaderProgram::uploadUniform(const std::string& name, glm::ivec3 value)
+{
+	use();
+	glUniform3i(glGetUniformLocation(shaderProgramHandle, name.c_str()), value.x, value.y, value.z);
+}
+
+void ShaderProgram::uploadUniform(const std::string& name, glm::ivec2 value)
+{
+	use();
+	glUniform2i(glGetUniformLocation(shaderProgramHandle, name.c_str()), value.x, value.y);
+}
+
 void ShaderProgram::uploadUniform(const std::string& name, glm::mat4 value)
 {
 	use();
@@ -229,9 +311,12 @@ void swap(ShaderProgram& lhs, ShaderProgram& rhs) noexcept
 	swap(lhs.vertexShaderPath, rhs.vertexShaderPath);
 	swap(lhs.fragmentShaderPath, rhs.fragmentShaderPath);
 	swap(lhs.geometryShaderPath, rhs.geometryShaderPath);
+	swap(lhs.computeShaderPath, rhs.computeShaderPath);
+	swap(lhs.defines, rhs.defines);
 	swap(lhs.shaderProgramHandle, rhs.shaderProgramHandle);
 	swap(lhs.vertexShaderHandle, rhs.vertexShaderHandle);
 	swap(lhs.fragmentShaderHandle, rhs.fragmentShaderHandle);
 	swap(lhs.geometryShaderHandle, rhs.geometryShaderHandle);
+	swap(lhs.computeShaderHandle, rhs.computeShaderHandle);
 
 }
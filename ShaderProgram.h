@@ -48,6 +48,12 @@ public:
 	 */
 	ShaderProgram(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& geometryShaderPath = "");
 
+	/**
+	 * @brief Constructor for a compute shader program.
+	 * @param computeShaderPath Path to the compute shader source.
+	 */
+	explicit ShaderProgram(const std::string& computeShaderPath);
+
 	/**
 	 * @brief Destructor.
 	 * 
@@ -58,10 +64,20 @@ public:
 	/**
 	 * @brief Compile Shader
 	 * 
-	 * Compiles the vertex and fragment shader. It does not link the program.
+	 * Compiles the vertex and fragment shader, or the compute shader for compute programs. It does not link the program.
 	 */
 	void compile();
 
+	/**
+	 * @brief Adds a preprocessor define to all stages.
+	 *
+	 * Takes effect on the next call to compile().
+	 *
+	 * @param name Name of the macro.
+	 * @param value Replacement text, may be empty.
+	 */
+	void addDefine(const std::string& name, const std::string& value = "");
+
 	/**
 	 * @brief Link Shader
 	 * 
@@ -86,6 +102,15 @@ public:
 	 */
 	void disable() const;
 
+	/**
+	 * @brief Uses the shader and dispatches compute work groups.
+	 * @param groupsX Number of work groups in x.
+	 * @param groupsY Number of work groups in y.
+	 * @param groupsZ Number of work groups in z.
+	 * @note Only valid for compute shader programs.
+	 */
+	void dispatch(GLuint groupsX, GLuint groupsY, GLuint groupsZ) const;
+
 	/**
 	 * @brief Gets the openGL shader program handle.
 	 * @return Program Handle.
@@ -127,6 +152,20 @@ public:
 	*/
 	void uploadUniform(const std::string& name, glm::vec4 value);
 
+	/**
+	* @brief Uploads a value as an uniform to the shader.
+	* @param name Name of the uniform.
+	* @param value Value to be upload.
+	*/
+	void uploadUniform(const std::string& name, glm::ivec3 value);
+
+	/**
+	* @brief Uploads a value as an uniform to the shader.
+	* @param name Name of the uniform.
+	* @param value Value to be upload.
+	*/
+	void uploadUniform(const std::string& name, glm::ivec2 value);
+
 	/**
 	* @brief Uploads a value as an uniform to the shader.
 	* @param name Name of the uniform.
@@ -156,6 +195,13 @@ public:
 	friend void swap(ShaderProgram& lhs, ShaderProgram& rhs) noexcept;
 private:
 
+	/**
+	 * @brief Reads a shader source file and inserts the defines after its #version line.
+	 * @param path Path to the shader source.
+	 * @return Source code.
+	 */
+	std::string loadSource(const std::string& path) const;
+
 	/**
 	 * @brief Path to the vertex shader source.
 	 */
@@ -171,6 +217,16 @@ private:
 	*/
 	std::string geometryShaderPath;
 
+	/**
+	* @brief Path to the compute shader source.
+	*/
+	std::string computeShaderPath;
+
+	/**
+	* @brief Preprocessor defines inserted into all stages.
+	*/
+	std::string defines;
+
 	/**
 	 * @brief OpenGL shader program handle.
 	 */
@@ -190,4 +246,9 @@ private:
 	* @brief OpenGL geometry shader handle.
 	*/
 	GLuint geometryShaderHandle;
+
+	/**
+	* @brief OpenGL compute shader handle.
+	*/
+	GLuint computeShaderHandle{ 0 };
 };
\ No newline at end of file
@@ -0,0 +1,132 @@
+/**
+* @file	StepHeatmap.cpp
+* @date	2026-10-19
+* @brief	Per-pixel cone step counts, their statistics and a heatmap view
+*/
+
+#include "StepHeatmap.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+const int StepHeatmap::QUANTITIES;
+const int StepHeatmap::TOTAL_STEPS;
+
+StepHeatmap::StepHeatmap(const std::string& csvPath) :
+	width{ 0 }, height{ 0 }, counts{ 0 }, vao{ 0 },
+	shader{ "resc/shaders/fullscreenVert.shader", "resc/shaders/stepHeatmapFrag.shader" },
+	csv{ csvPath }, frame{ 0 }, pixels{ 0 }, statistics{}
+{
+	shader.compile();
+	shader.link();
+	glCreateVertexArrays(1, &vao);
+
+	csv << "frame,pixels,cone_tracing_ms";
+	for (int quantity = 0; quantity < QUANTITIES; ++quantity)
+	{
+		const std::string name = getName(quantity);
+		csv << "," << name << "_mean," << name << "_p95," << name << "_max";
+	}
+	csv << ",voxel_fetches_total" << std::endl;
+}
+
+StepHeatmap::~StepHeatmap()
+{
+	glDeleteTextures(1, &counts);
+	glDeleteVertexArrays(1, &vao);
+}
+
+void StepHeatmap::begin(int _width, int _height)
+{
+	if (_width != width || _height != height)
+	{
+		glDeleteTextures(1, &counts);
+		width = _width;
+		height = _height;
+		glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &counts);
+		glTextureStorage3D(counts, 1, GL_R32UI, width, height, LAYERS);
+	}
+	glClearTexImage(counts, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
+void StepHeatmap::bindImage(GLuint unit) const
+{
+	glBindImageTexture(unit, counts, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+}
+
+void StepHeatmap::collect(double coneTracingMs)
+{
+	const std::size_t layerSize = (std::size_t)width * height;
+	std::vector<GLuint> values(LAYERS * layerSize);
+	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+	glGetTextureImage(counts, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, (GLsizei)(values.size() * sizeof(GLuint)), values.data());
+
+	// Only pixels that traced any cone count, background and views without cones would dilute the mean
+	std::vector<GLuint> quantities[QUANTITIES];
+	for (std::size_t pixel = 0; pixel < layerSize; ++pixel)
+	{
+		const GLuint total = values[pixel] + values[layerSize + pixel] + values[2 * layerSize + pixel];
+		if (total == 0)
+			continue;
+		for (int layer = 0; layer < LAYERS; ++layer)
+			quantities[layer].push_back(values[layer * layerSize + pixel]);
+		quantities[TOTAL_STEPS].push_back(total);
+	}
+
+	pixels = quantities[TOTAL_STEPS].size();
+	for (int quantity = 0; quantity < QUANTITIES; ++quantity)
+	{
+		std::vector<GLuint>& samples = quantities[quantity];
+		Statistics& stats = statistics[quantity];
+		stats = Statistics{};
+		if (samples.empty())
+			continue;
+
+		for (GLuint value : samples)
+			stats.sum += value;
+		stats.mean = (double)stats.sum / samples.size();
+		auto p95 = samples.begin() + (samples.size() - 1) * 95 / 100;
+		std::nth_element(samples.begin(), p95, samples.end());
+		stats.p95 = *p95;
+		stats.max = *std::max_element(p95, samples.end());
+	}
+
+	csv << frame++ << "," << pixels << "," << coneTracingMs;
+	for (const Statistics& stats : statistics)
+		csv << "," << stats.mean << "," << stats.p95 << "," << stats.max;
+	csv << "," << statistics[VOXEL_FETCHES].sum << std::endl;
+}
+
+void StepHeatmap::draw(int quantity)
+{
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	bindImage(6);
+	shader.use();
+	shader.uploadUniform("quantity", quantity);
+	shader.uploadUniform("scale", 1.f / std::max(statistics[quantity].p95, 1u));
+	glBindVertexArray(vao);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glEnable(GL_DEPTH_TEST);
+}
+
+void StepHeatmap::report(std::ostream& os) const
+{
+	os << "Step heatmap over " << pixels << " pixels:" << std::endl;
+	for (int quantity = 0; quantity < QUANTITIES; ++quantity)
+	{
+		const Statistics& stats = statistics[quantity];
+		os << "  " << std::setw(16) << std::left << getName(quantity) << std::right << "mean " << stats.mean
+			<< ", p95 " << stats.p95 << ", max " << stats.max << std::endl;
+	}
+}
+
+const char* StepHeatmap::getName(int quantity)
+{
+	static const char* names[QUANTITIES] = { "diffuse_steps", "specular_steps", "shadow_steps", "voxel_fetches", "total_steps" };
+	return names[quantity];
+}
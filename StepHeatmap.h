@@ -0,0 +1,103 @@
+/**
+* @file	StepHeatmap.h
+* @date	2026-10-19
+* @brief	Per-pixel cone step counts, their statistics and a heatmap view
+*/
+
+#pragma once
+
+#include <fstream>
+#include <ostream>
+#include <string>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "ShaderProgram.h"
+
+/**
+ * @brief Records how many steps the cones of each pixel took and how many voxel samples they fetched.
+ *
+ * The instrumented cone tracing permutation adds its counts to an R32UI array image with one
+ * layer per quantity. Every collected frame is read back, which stalls the pipeline, and summarized
+ * over the pixels that traced any cone into a row of a CSV file.
+ */
+class StepHeatmap
+{
+public:
+	// Layers of the image, the total of the three cone types is derived when collecting
+	enum LAYER { DIFFUSE_STEPS, SPECULAR_STEPS, SHADOW_STEPS, VOXEL_FETCHES, LAYERS };
+
+	// Quantities summarized and viewable, the layers followed by the steps of all cone types
+	static const int QUANTITIES = LAYERS + 1;
+	static const int TOTAL_STEPS = LAYERS;
+
+	StepHeatmap() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param csvPath File receiving one row of statistics per collected frame, overwritten.
+	 */
+	explicit StepHeatmap(const std::string& csvPath);
+
+	~StepHeatmap();
+
+	StepHeatmap(const StepHeatmap&) = delete;
+	StepHeatmap& operator=(const StepHeatmap&) = delete;
+
+	/**
+	 * @brief Clears the counts for a new frame, reallocating them when the size changed.
+	 * @param width Width in pixels.
+	 * @param height Height in pixels.
+	 */
+	void begin(int width, int height);
+
+	/**
+	 * @brief Binds the counts as an image the cone tracing shader adds to.
+	 * @param unit Image unit to bind to.
+	 */
+	void bindImage(GLuint unit) const;
+
+	/**
+	 * @brief Reads the counts back and appends their statistics to the CSV file.
+	 * @param coneTracingMs GPU time of the cone tracing pass, written along.
+	 */
+	void collect(double coneTracingMs);
+
+	/**
+	 * @brief Draws one quantity over the screen, scaled by its 95th percentile of the last collected frame.
+	 * @param quantity Layer, or TOTAL_STEPS.
+	 */
+	void draw(int quantity);
+
+	/**
+	 * @brief Writes the statistics of the last collected frame.
+	 * @param os Stream to write to.
+	 */
+	void report(std::ostream& os) const;
+
+	/**
+	 * @brief Gets the name of a quantity.
+	 * @param quantity Layer, or TOTAL_STEPS.
+	 */
+	static const char* getName(int quantity);
+
+private:
+	struct Statistics
+	{
+		double mean{ 0.0 };
+		GLuint p95{ 0 };
+		GLuint max{ 0 };
+		GLuint64 sum{ 0 };
+	};
+
+	int width;
+	int height;
+	GLuint counts;
+	GLuint vao;
+	ShaderProgram shader;
+	std::ofstream csv;
+	int frame;
+	GLuint64 pixels;
+	Statistics statistics[QUANTITIES];
+};
@@ -0,0 +1,82 @@
+/**
+* @file	TemporalAccumulator.cpp
+* @date	2026-10-19
+* @brief	Accumulation of indirect diffuse irradiance over frames
+*/
+
+#include "TemporalAccumulator.h"
+
+TemporalAccumulator::TemporalAccumulator() :
+	width{ 0 }, height{ 0 }, frame{ 0 }, current{ 0 }, irradiance{ 0, 0 }, surface{ 0, 0 },
+	shader{ "resc/shaders/diffuseTemporalComp.shader" }
+{
+	shader.compile();
+	shader.link();
+}
+
+TemporalAccumulator::~TemporalAccumulator()
+{
+	destroyHistory();
+}
+
+void TemporalAccumulator::accumulate(const IndirectDiffuseBuffer& buffer, float minBlend)
+{
+	if (buffer.getWidth() != width || buffer.getHeight() != height)
+	{
+		destroyHistory();
+		createHistory(buffer.getWidth(), buffer.getHeight());
+	}
+
+	const int previous = current;
+	current = 1 - current;
+
+	buffer.bindImages(0);
+	glBindImageTexture(3, irradiance[previous], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+	glBindImageTexture(4, surface[previous], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+	glBindImageTexture(5, irradiance[current], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+	glBindImageTexture(6, surface[current], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+	shader.uploadUniform("hasHistory", frame > 0 ? 1 : 0);
+	shader.uploadUniform("minBlend", minBlend);
+	shader.dispatch((width + 7) / 8, (height + 7) / 8, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	++frame;
+}
+
+void TemporalAccumulator::bindResult(GLuint unit) const
+{
+	glBindImageTexture(unit, irradiance[current], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+}
+
+void TemporalAccumulator::reset()
+{
+	frame = 0;
+}
+
+int TemporalAccumulator::getFrame() const
+{
+	return frame;
+}
+
+void TemporalAccumulator::createHistory(int _width, int _height)
+{
+	width = _width;
+	height = _height;
+	glCreateTextures(GL_TEXTURE_2D, 2, irradiance);
+	glCreateTextures(GL_TEXTURE_2D, 2, surface);
+	for (int i = 0; i < 2; ++i)
+	{
+		glTextureStorage2D(irradiance[i], 1, GL_RGBA16F, width, height);
+		glTextureStorage2D(surface[i], 1, GL_RGBA32F, width, height);
+	}
+	frame = 0;
+}
+
+void TemporalAccumulator::destroyHistory()
+{
+	if (irradiance[0] != 0)
+	{
+		glDeleteTextures(2, irradiance);
+		glDeleteTextures(2, surface);
+	}
+	irradiance[0] = irradiance[1] = surface[0] = surface[1] = 0;
+}
@@ -0,0 +1,71 @@
+/**
+* @file	TemporalAccumulator.h
+* @date	2026-10-19
+* @brief	Accumulation of indirect diffuse irradiance over frames
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "IndirectDiffuseBuffer.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Blends the irradiance of each frame into a reprojected history.
+ *
+ * The history is fetched where the motion of a pixel says its surface was in the previous
+ * frame. Samples whose stored depth or normal do not match are treated as disoccluded, and
+ * the history is clamped to the mean and deviation of the current 3x3 neighbourhood before
+ * an exponential moving average, which converges like a plain average over the first frames.
+ */
+class TemporalAccumulator
+{
+public:
+	TemporalAccumulator();
+	~TemporalAccumulator();
+
+	TemporalAccumulator(const TemporalAccumulator&) = delete;
+	TemporalAccumulator& operator=(const TemporalAccumulator&) = delete;
+
+	/**
+	 * @brief Blends the irradiance of the current frame into the history, reallocating it when the size changed.
+	 * @param buffer Buffer holding irradiance, surface and motion of the current frame.
+	 * @param minBlend Weight of the current frame once the history is long, lower is smoother but lags more.
+	 */
+	void accumulate(const IndirectDiffuseBuffer& buffer, float minBlend);
+
+	/**
+	 * @brief Binds the accumulated irradiance as a read only image.
+	 * @param unit Image unit to bind to.
+	 */
+	void bindResult(GLuint unit) const;
+
+	/**
+	 * @brief Discards the history, the next frame starts accumulating anew.
+	 */
+	void reset();
+
+	/**
+	 * @brief Gets the number of frames accumulated since the last reset, used to rotate the cones.
+	 */
+	int getFrame() const;
+
+private:
+	void createHistory(int width, int height);
+	void destroyHistory();
+
+	int width;
+	int height;
+	int frame;
+	int current;
+
+	/**
+	 * @brief Irradiance with the history length in alpha, and normal with linear depth, ping-ponged
+	 */
+	GLuint irradiance[2];
+	GLuint surface[2];
+
+	ShaderProgram shader;
+};
@@ -6,14 +6,48 @@
 */
 
 #include "Texture3D.h"
+#include "MappedFile.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <vector>
 
-Texture3D::Texture3D(const std::vector<GLfloat> & textureBuffer, const int _width, const int _height, const int _depth) :
-	width(_width), height(_height), depth(_depth)
+namespace
 {
+	const char fileMagic[4] = { 'V', 'O', 'X', '3' };
+	const std::uint32_t fileVersion = 2;
+	const int brickSize = 8;
+
+	// Size of a mip level
+	glm::ivec3 levelSize(int width, int height, int depth, int level)
+	{
+		return glm::max(glm::ivec3(width, height, depth) >> level, glm::ivec3(1));
+	}
+
+	// Bytes of the brick occupancy mask, padded to keep the texel data aligned
+	std::size_t maskSize(const glm::ivec3& bricks)
+	{
+		return ((bricks.x * bricks.y * bricks.z + 31) / 32) * 4;
+	}
+
+	// Integer formats only accept integer clear data
+	bool isIntegerFormat(GLenum format)
+	{
+		return format == GL_R32UI || format == GL_R32I || format == GL_RG32UI || format == GL_RGBA32UI
+			|| format == GL_R8UI || format == GL_RGBA8UI;
+	}
+}
+
+Texture3D::Texture3D(const int _width, const int _height, const int _depth, const GLenum _format, const bool mipmapped) :
+	width(_width), height(_height), depth(_depth), levels(1), format(_format)
+{
+	// Full mip chain down to a single voxel
+	for (int size = std::max({ width, height, depth }); mipmapped && size > 1; size /= 2)
+		++levels;
+
 	// Generate texture on GPU.
-	//glEnable(GL_TEXTURE_3D);
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_3D, textureID);
 
@@ -22,32 +56,33 @@ Texture3D::Texture3D(const std::vector<GLfloat> & textureBuffer, const int _widt
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_BORDER);
 
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-	// Upload the texture buffer.
+	// Allocate immutable storage, no data is uploaded.
 	glTexStorage3D(
 		GL_TEXTURE_3D,			// texture
-		7,						// levels, tweak if necessary
-		GL_RGBA8,				// internalformat
+		levels,					// levels
+		format,					// internalformat
 		width,					// width
 		height,					// heigth
 		depth);					// depth
 
-	glTexImage3D(
-		GL_TEXTURE_3D,			// target
-		0,						// level
-		GL_RGBA8,				// internalformat
-		width,					// width
-		height,					// height
-		depth,					// depth
-		0,						// border
-		GL_RGBA,				// format
-		GL_FLOAT,				// type
-		&textureBuffer[0]);		// data
-
-	glGenerateMipmap(GL_TEXTURE_3D);
 	glBindTexture(GL_TEXTURE_3D, 0);
+
+	// Storage content is undefined until cleared
+	for (int level = 0; level < levels; ++level)
+	{
+		if (isIntegerFormat(format))
+			glClearTexImage(textureID, level, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		else
+			glClearTexImage(textureID, level, GL_RGBA, GL_FLOAT, nullptr);
+	}
+}
+
+Texture3D::~Texture3D()
+{
+	glDeleteTextures(1, &textureID);
 }
 
 void Texture3D::Clear(GLfloat clearColor[4])
@@ -55,10 +90,139 @@ void Texture3D::Clear(GLfloat clearColor[4])
 	GLint previousBoundTextureID;
 	glGetIntegerv(GL_TEXTURE_BINDING_3D, &previousBoundTextureID);
 	glBindTexture(GL_TEXTURE_3D, textureID);
-	glClearTexImage(textureID, 0, GL_RGBA, GL_FLOAT, &clearColor);
+	glClearTexImage(textureID, 0, GL_RGBA, GL_FLOAT, clearColor);
 	glBindTexture(GL_TEXTURE_3D, previousBoundTextureID);
 }
 
+void Texture3D::Clear(GLfloat clearColor[4], glm::ivec3 offset, glm::ivec3 size)
+{
+	glClearTexSubImage(textureID, 0, offset.x, offset.y, offset.z, size.x, size.y, size.z, GL_RGBA, GL_FLOAT, clearColor);
+}
+
+bool Texture3D::save(const std::string& path) const
+{
+	if (format != GL_RGBA8)
+		return false;
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	// Voxelization writes with image stores, which a readback only sees after this barrier
+	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+	const std::uint32_t header[] = {
+		fileVersion,
+		static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), static_cast<std::uint32_t>(depth),
+		static_cast<std::uint32_t>(levels), GL_RGBA8, brickSize
+	};
+	file.write(fileMagic, sizeof(fileMagic));
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	std::vector<unsigned char> texels;
+	std::vector<unsigned char> bricksData;
+	for (int level = 0; level < levels; ++level)
+	{
+		const glm::ivec3 size = levelSize(width, height, depth, level);
+		texels.resize(4 * size.x * size.y * size.z);
+		glGetTextureImage(textureID, level, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLsizei>(texels.size()), texels.data());
+
+		const glm::ivec3 bricks = (size + brickSize - 1) / brickSize;
+		std::vector<unsigned char> mask(maskSize(bricks), 0);
+		std::uint32_t storedBricks = 0;
+		bricksData.clear();
+
+		int brickIndex = 0;
+		for (int bz = 0; bz < bricks.z; ++bz)
+		for (int by = 0; by < bricks.y; ++by)
+		for (int bx = 0; bx < bricks.x; ++bx, ++brickIndex)
+		{
+			const glm::ivec3 origin = glm::ivec3(bx, by, bz) * brickSize;
+			const glm::ivec3 extent = glm::min(glm::ivec3(brickSize), size - origin);
+
+			// Gather the brick and keep it only if any texel is set
+			const std::size_t start = bricksData.size();
+			bool empty = true;
+			for (int z = 0; z < extent.z; ++z)
+			for (int y = 0; y < extent.y; ++y)
+			{
+				const unsigned char* row = &texels[4 * (origin.x + size.x * ((origin.y + y) + size.y * (origin.z + z)))];
+				bricksData.insert(bricksData.end(), row, row + 4 * extent.x);
+				empty = empty && std::all_of(row, row + 4 * extent.x, [](unsigned char c) { return c == 0; });
+			}
+
+			if (empty)
+			{
+				bricksData.resize(start);
+				continue;
+			}
+
+			mask[brickIndex / 8] |= 1 << (brickIndex % 8);
+			++storedBricks;
+		}
+
+		file.write(reinterpret_cast<const char*>(&storedBricks), sizeof(storedBricks));
+		file.write(reinterpret_cast<const char*>(mask.data()), mask.size());
+		file.write(reinterpret_cast<const char*>(bricksData.data()), bricksData.size());
+	}
+
+	return static_cast<bool>(file);
+}
+
+bool Texture3D::load(const std::string& path)
+{
+	MappedFile file(path);
+	const std::size_t headerSize = sizeof(fileMagic) + 7 * sizeof(std::uint32_t);
+	if (!file.isOpen() || file.size() < headerSize || std::memcmp(file.data(), fileMagic, sizeof(fileMagic)) != 0)
+		return false;
+
+	std::uint32_t header[7];
+	std::memcpy(header, file.data() + sizeof(fileMagic), sizeof(header));
+	const std::uint32_t expected[] = {
+		fileVersion,
+		static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), static_cast<std::uint32_t>(depth),
+		static_cast<std::uint32_t>(levels), static_cast<std::uint32_t>(format), brickSize
+	};
+	if (std::memcmp(header, expected, sizeof(header)) != 0)
+		return false;
+
+	// Bricks are uploaded straight from the mapping, empty space is cleared on the GPU
+	const unsigned char* cursor = file.data() + headerSize;
+	const unsigned char* end = file.data() + file.size();
+	for (int level = 0; level < levels; ++level)
+	{
+		const glm::ivec3 size = levelSize(width, height, depth, level);
+		const glm::ivec3 bricks = (size + brickSize - 1) / brickSize;
+		if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(std::uint32_t) + maskSize(bricks)))
+			return false;
+
+		const unsigned char* mask = cursor + sizeof(std::uint32_t);
+		cursor = mask + maskSize(bricks);
+
+		glClearTexImage(textureID, level, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		int brickIndex = 0;
+		for (int bz = 0; bz < bricks.z; ++bz)
+		for (int by = 0; by < bricks.y; ++by)
+		for (int bx = 0; bx < bricks.x; ++bx, ++brickIndex)
+		{
+			if ((mask[brickIndex / 8] & (1 << (brickIndex % 8))) == 0)
+				continue;
+
+			const glm::ivec3 origin = glm::ivec3(bx, by, bz) * brickSize;
+			const glm::ivec3 extent = glm::min(glm::ivec3(brickSize), size - origin);
+			const std::ptrdiff_t bytes = 4 * extent.x * extent.y * extent.z;
+			if (end - cursor < bytes)
+				return false;
+
+			glTextureSubImage3D(textureID, level, origin.x, origin.y, origin.z, extent.x, extent.y, extent.z, GL_RGBA, GL_UNSIGNED_BYTE, cursor);
+			cursor += bytes;
+		}
+	}
+
+	return true;
+}
+
 void Texture3D::bind(GLuint texUnit) const
 {
 	GLint numTextureUnits;
@@ -74,3 +238,27 @@ void Texture3D::bind(GLuint texUnit) const
 	glBindTexture(GL_TEXTURE_3D, textureID);
 }
 
+int Texture3D::getWidth() const
+{
+	return width;
+}
+
+int Texture3D::getHeight() const
+{
+	return height;
+}
+
+int Texture3D::getDepth() const
+{
+	return depth;
+}
+
+int Texture3D::getLevels() const
+{
+	return levels;
+}
+
+GLenum Texture3D::getFormat() const
+{
+	return format;
+}
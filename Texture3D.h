@@ -7,28 +7,69 @@
 
 #pragma once
 
-#include <vector>
+#include <string>
 
 #include <glew.h>
 #include <GLFW/glfw3.h>
 
+#include <glm/glm.hpp>
+
 // A 3D texture wrapper class
+//
+// Voxel grid files (.vox) hold every mip level of the RGBA8 texture, split into
+// 8x8x8 bricks where bricks with only zero texels are left out. Layout, little endian:
+//   char[4]	magic "VOX3"
+//   uint32	version, width, height, depth, levels, internal format, brick size
+//   per level, with sizes halved and rounded down to at least 1:
+//     uint32	number of stored bricks
+//     uint8[]	one bit per brick, x fastest then y then z, padded to a multiple of 4 bytes
+//     RGBA8	texels of each stored brick in the same order, x fastest, clipped at the level edges
 class Texture3D {
 public:
+	// Allocates immutable storage with a full mip chain, or only the base level, and clears it to zero on the GPU
 	Texture3D(
-		const std::vector<GLfloat> & textureBuffer,
-		const int width, const int height, const int depth
+		const int width, const int height, const int depth,
+		const GLenum internalFormat = GL_RGBA8,
+		const bool mipmapped = true
 	);
 
-	unsigned char * textureBuffer = nullptr;
+	~Texture3D();
+
+	Texture3D(const Texture3D&) = delete;
+	Texture3D& operator=(const Texture3D&) = delete;
+
 	GLuint textureID;
 
 	// Clears this texture using a given clear color
 	void Clear(GLfloat clearColor[4]);
 
+	// Clears a region of level 0 using a given clear color
+	void Clear(GLfloat clearColor[4], glm::ivec3 offset, glm::ivec3 size);
+
+	// Writes all mip levels to a voxel grid file, returns false if the file could not be written
+	// or the texture is not RGBA8
+	bool save(const std::string& path) const;
+
+	// Memory maps a voxel grid file and uploads all mip levels from it, returns false if the file
+	// is missing or does not match the size and format of this texture
+	bool load(const std::string& path);
+
 	// Binds the texture to index texUnit
 	void bind(GLuint texUnit) const;
 
+	// Dimensions of the base level
+	int getWidth() const;
+	int getHeight() const;
+	int getDepth() const;
+
+	// Number of allocated mip levels, down to 1x1x1 if mipmapped
+	int getLevels() const;
+
+	// Sized internal format
+	GLenum getFormat() const;
+
 private:
 	int width, height, depth;
+	int levels;
+	GLenum format;
 };
\ No newline at end of file
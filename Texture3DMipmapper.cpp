@@ -0,0 +1,53 @@
+/**
+* @file	Texture3DMipmapper.cpp
+* @date	2026-10-19
+* @brief	Compute shader mip builder for 3D textures
+*/
+
+#include "Texture3DMipmapper.h"
+
+Texture3DMipmapper::Texture3DMipmapper(VOXEL_FORMAT format) :
+	shader{ "resc/shaders/mipmapComp.shader" }
+{
+	addVoxelFormatDefines(shader, format);
+	shader.compile();
+	shader.link();
+}
+
+void Texture3DMipmapper::generateMipmaps(const Texture3D& texture, const Texture3D* opacity)
+{
+	generateMipmaps(texture, opacity, glm::ivec3(0), glm::ivec3(texture.getWidth(), texture.getHeight(), texture.getDepth()));
+}
+
+void Texture3DMipmapper::generateMipmaps(const Texture3D& texture, const Texture3D* opacity, glm::ivec3 regionMin, glm::ivec3 regionMax)
+{
+	texture.bind(0);
+	shader.uploadUniform("source", 0);
+	if (opacity != nullptr)
+	{
+		opacity->bind(1);
+		shader.uploadUniform("opacitySource", 1);
+	}
+
+	for (int level = 1; level < texture.getLevels(); ++level)
+	{
+		// Region of this level touched by the level 0 region, rounded outwards
+		const glm::ivec3 levelMin = regionMin >> level;
+		const glm::ivec3 levelMax = (regionMax + glm::ivec3((1 << level) - 1)) >> level;
+		const glm::ivec3 levelSize = levelMax - levelMin;
+		if (levelSize.x <= 0 || levelSize.y <= 0 || levelSize.z <= 0)
+			break;
+
+		shader.uploadUniform("sourceLevel", level - 1);
+		shader.uploadUniform("premultiply", level == 1 ? 1 : 0);
+		shader.uploadUniform("regionOffset", levelMin);
+		shader.uploadUniform("regionSize", levelSize);
+
+		glBindImageTexture(0, texture.textureID, level, GL_TRUE, 0, GL_WRITE_ONLY, texture.getFormat());
+		if (opacity != nullptr)
+			glBindImageTexture(2, opacity->textureID, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+
+		shader.dispatch((levelSize.x + 3) / 4, (levelSize.y + 3) / 4, (levelSize.z + 3) / 4);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+}
@@ -0,0 +1,53 @@
+/**
+* @file	Texture3DMipmapper.h
+* @date	2026-10-19
+* @brief	Compute shader mip builder for 3D textures
+*/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Texture3D.h"
+#include "ShaderProgram.h"
+#include "VoxelFormat.h"
+
+/**
+ * @brief Builds the mip chain of a Texture3D with one compute dispatch per level.
+ *
+ * Level 0 is treated as straight colour with coverage in alpha and is premultiplied
+ * while reducing, so empty voxels do not darken their neighbours. Every level above
+ * holds premultiplied colour, which is what the cone tracer accumulates. For formats
+ * without alpha the coverage lives in a separate R8 opacity texture mipmapped alongside.
+ */
+class Texture3DMipmapper
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param format Format of the textures to mipmap.
+	 */
+	explicit Texture3DMipmapper(VOXEL_FORMAT format = VOXEL_FORMAT::RGBA8);
+
+	Texture3DMipmapper(const Texture3DMipmapper&) = delete;
+	Texture3DMipmapper& operator=(const Texture3DMipmapper&) = delete;
+
+	/**
+	 * @brief Rebuilds all mip levels from level 0.
+	 * @param texture Texture to mipmap.
+	 * @param opacity Opacity texture to mipmap along with texture, required for formats without alpha.
+	 */
+	void generateMipmaps(const Texture3D& texture, const Texture3D* opacity);
+
+	/**
+	 * @brief Rebuilds the parts of all mip levels covering a region of level 0.
+	 * @param texture Texture to mipmap.
+	 * @param opacity Opacity texture to mipmap along with texture, required for formats without alpha.
+	 * @param regionMin First voxel of the changed level 0 region.
+	 * @param regionMax One past the last voxel of the changed level 0 region.
+	 */
+	void generateMipmaps(const Texture3D& texture, const Texture3D* opacity, glm::ivec3 regionMin, glm::ivec3 regionMax);
+
+private:
+	ShaderProgram shader;
+};
@@ -0,0 +1,75 @@
+/**
+* @file	TriangleVoxelizer.cpp
+* @date	2026-10-19
+* @brief	Compute shader voxelization of small triangles
+*/
+
+#include "TriangleVoxelizer.h"
+
+TriangleVoxelizer::TriangleVoxelizer() :
+	shader{ "resc/shaders/triangleVoxelizationComp.shader" }, largeTriangles{ 0 }, largeTrianglesCapacity{ 0 },
+	drawCommand{ 0 }, sizeThreshold{ 2.f }
+{
+	shader.compile();
+	shader.link();
+
+	glCreateBuffers(1, &largeTriangles);
+	glCreateBuffers(1, &drawCommand);
+	glNamedBufferStorage(drawCommand, 5 * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+}
+
+TriangleVoxelizer::~TriangleVoxelizer()
+{
+	glDeleteBuffers(1, &largeTriangles);
+	glDeleteBuffers(1, &drawCommand);
+}
+
+ShaderProgram& TriangleVoxelizer::getShader()
+{
+	return shader;
+}
+
+void TriangleVoxelizer::voxelize(RawModel& model)
+{
+	const GLuint indexCount = model.getIndexCount();
+	if (indexCount > largeTrianglesCapacity)
+	{
+		largeTrianglesCapacity = indexCount;
+		glNamedBufferData(largeTriangles, largeTrianglesCapacity * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	// count, instanceCount, firstIndex, baseVertex, baseInstance
+	const GLuint command[5] = { 0, 1, 0, 0, 0 };
+	glNamedBufferSubData(drawCommand, 0, sizeof(command), command);
+
+	model.bindStorageBuffers();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, largeTriangles);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, drawCommand);
+
+	const GLuint triangleCount = indexCount / 3;
+	shader.uploadUniform("triangleCount", (GLint)triangleCount);
+	shader.uploadUniform("sizeThreshold", sizeThreshold);
+	shader.dispatch((triangleCount + 63) / 64, 1, 1);
+
+	// The raster pass averages into the same geometry volumes with image atomics
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT
+		| GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+void TriangleVoxelizer::drawLargeTriangles(RawModel& model, bool vertexPulling)
+{
+	if (vertexPulling)
+		model.drawVertexPullingIndirect(largeTriangles, drawCommand);
+	else
+		model.drawIndirect(largeTriangles, drawCommand);
+}
+
+void TriangleVoxelizer::setSizeThreshold(GLfloat voxels)
+{
+	sizeThreshold = voxels;
+}
+
+GLfloat TriangleVoxelizer::getSizeThreshold() const
+{
+	return sizeThreshold;
+}
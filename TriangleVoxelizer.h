@@ -0,0 +1,75 @@
+/**
+* @file	TriangleVoxelizer.h
+* @date	2026-10-19
+* @brief	Compute shader voxelization of small triangles
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "RawModel.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Voxelizes the triangles of a model covering only a few voxels with one compute invocation each.
+ *
+ * Rasterizing a triangle smaller than a voxel still costs a full primitive setup for a single
+ * fragment, which dominates dense meshes. Triangles whose voxel space bounding box fits within
+ * the size threshold are written by looping over that box, every other triangle is appended
+ * to an index buffer drawn indirectly by the raster path afterwards.
+ *
+ * The shader expects the same uniforms as the voxelization fragment shader and the geometry
+ * volumes bound to image units 0-5, the caller uploads them through getShader().
+ */
+class TriangleVoxelizer
+{
+public:
+	TriangleVoxelizer();
+	~TriangleVoxelizer();
+
+	TriangleVoxelizer(const TriangleVoxelizer&) = delete;
+	TriangleVoxelizer& operator=(const TriangleVoxelizer&) = delete;
+
+	/**
+	 * @brief Gets the compute shader for uploading uniforms.
+	 */
+	ShaderProgram& getShader();
+
+	/**
+	 * @brief Voxelizes the small triangles of a model and collects the large ones.
+	 * @param model Model to voxelize.
+	 */
+	void voxelize(RawModel& model);
+
+	/**
+	 * @brief Rasterizes the large triangles collected by the last call to voxelize with the bound shader.
+	 * @param model Model passed to voxelize.
+	 * @param vertexPulling Whether the bound shader pulls its vertices from storage buffers.
+	 */
+	void drawLargeTriangles(RawModel& model, bool vertexPulling);
+
+	/**
+	 * @brief Sets the largest bounding box extent in voxels handled by the compute shader.
+	 * @param voxels Extent along every axis, 0 sends all triangles to the raster path.
+	 */
+	void setSizeThreshold(GLfloat voxels);
+	GLfloat getSizeThreshold() const;
+
+private:
+	ShaderProgram shader;
+
+	/**
+	 * @brief Indices of the triangles left to the raster path
+	 */
+	GLuint largeTriangles;
+	GLuint largeTrianglesCapacity;
+
+	/**
+	 * @brief DrawElementsIndirectCommand counting the indices in largeTriangles
+	 */
+	GLuint drawCommand;
+
+	GLfloat sizeThreshold;
+};
@@ -18,6 +18,17 @@ std::string getStringFromFile(const std::string& path)
 	return std::string{ std::istreambuf_iterator<char>(std::ifstream(path)), std::istreambuf_iterator<char>() };
 }
 
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		seed ^= bytes[i];
+		seed *= 1099511628211ull;
+	}
+	return seed;
+}
+
 std::ostream& operator<<(std::ostream& os,const glm::vec3& vec)
 {
 	return os << '{' << vec.x << ',' << vec.y << ',' << vec.z << '}';
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <glm/glm.hpp>
 
@@ -17,6 +19,15 @@
  */
 std::string getStringFromFile(const std::string& path);
 
+/**
+ * @brief Hashes a block of memory with 64 bit FNV-1a
+ * @param data Data to hash
+ * @param size Size of data in bytes
+ * @param seed Hash to continue from, allows hashing several blocks in sequence
+ * @return Hash value
+ */
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed = 14695981039346656037ull);
+
 std::ostream& operator<<(std::ostream& os, const glm::vec3& vec);
 
 std::istream& operator>>(std::istream& is, glm::vec3& vec);
\ No newline at end of file
@@ -0,0 +1,206 @@
+/**
+* @file	VoxelDistanceField.cpp
+* @date	2026-10-19
+* @brief	Distance from every cell of a voxel grid to the nearest geometry
+*/
+
+#include "VoxelDistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const float INF = 1e20f;
+
+	// Lower envelope of parabolas rooted at the sampled squared distances, f and d may not alias
+	void distanceTransform1D(const float* f, float* d, int n, std::vector<int>& v, std::vector<float>& z)
+	{
+		int k = 0;
+		v[0] = 0;
+		z[0] = -INF;
+		z[1] = INF;
+		for (int q = 1; q < n; ++q)
+		{
+			if (f[q] >= INF)
+				continue;
+			if (f[v[0]] >= INF)
+			{
+				v[0] = q;
+				continue;
+			}
+
+			float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.f * q - 2.f * v[k]);
+			while (s <= z[k])
+			{
+				--k;
+				s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.f * q - 2.f * v[k]);
+			}
+			++k;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = INF;
+		}
+
+		k = 0;
+		for (int q = 0; q < n; ++q)
+		{
+			while (z[k + 1] < q)
+				++k;
+			d[q] = f[v[k]] >= INF ? INF : (q - v[k]) * (q - v[k]) + f[v[k]];
+		}
+	}
+}
+
+const int VoxelDistanceField::CELL_SIZE;
+constexpr float VoxelDistanceField::NO_GEOMETRY;
+
+VoxelDistanceField::VoxelDistanceField(glm::ivec3 gridSize) :
+	size{ glm::max((gridSize + CELL_SIZE - 1) / CELL_SIZE, glm::ivec3(1)) },
+	seeds{ nullptr, nullptr },
+	seedShader{ "resc/shaders/distanceSeedComp.shader" },
+	floodShader{ "resc/shaders/distanceFloodComp.shader" },
+	resolveShader{ "resc/shaders/distanceResolveComp.shader" }
+{
+	for (ShaderProgram* shader : { &seedShader, &floodShader, &resolveShader })
+	{
+		shader->compile();
+		shader->link();
+	}
+
+	for (auto& seed : seeds)
+		seed = new Texture3D(size.x, size.y, size.z, GL_R32UI);
+}
+
+VoxelDistanceField::~VoxelDistanceField()
+{
+	for (auto seed : seeds)
+		delete seed;
+}
+
+void VoxelDistanceField::build(const Texture3D& geometry, const Texture3D& distance)
+{
+	const glm::ivec3 groups = (size + 3) / 4;
+
+	geometry.bind(0);
+	seedShader.uploadUniform("geometry", 0);
+	seedShader.uploadUniform("cellSize", CELL_SIZE);
+	glBindImageTexture(0, seeds[0]->textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32UI);
+	seedShader.dispatch(groups.x, groups.y, groups.z);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	// Steps halve from half the field down to one, then one more pass of step one
+	int largest = 1;
+	while (2 * largest < std::max({ size.x, size.y, size.z }))
+		largest *= 2;
+
+	int source = 0;
+	for (int step = largest; ; step /= 2)
+	{
+		const int passStep = std::max(step, 1);
+		floodShader.uploadUniform("stepSize", passStep);
+		glBindImageTexture(0, seeds[source]->textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_R32UI);
+		glBindImageTexture(1, seeds[1 - source]->textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32UI);
+		floodShader.dispatch(groups.x, groups.y, groups.z);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		source = 1 - source;
+
+		if (step == 0)
+			break;
+	}
+
+	glBindImageTexture(0, seeds[source]->textureID, 0, GL_TRUE, 0, GL_READ_ONLY, GL_R32UI);
+	glBindImageTexture(1, distance.textureID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+	resolveShader.uploadUniform("noGeometry", NO_GEOMETRY);
+	resolveShader.dispatch(groups.x, groups.y, groups.z);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+}
+
+void VoxelDistanceField::validate(const Texture3D& geometry, const Texture3D& distance, std::ostream& os) const
+{
+	const glm::ivec3 gridSize(geometry.getWidth(), geometry.getHeight(), geometry.getDepth());
+	std::vector<std::uint8_t> voxels(4 * (std::size_t)gridSize.x * gridSize.y * gridSize.z);
+	glGetTextureImage(geometry.textureID, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)voxels.size(), voxels.data());
+
+	const std::size_t cellCount = (std::size_t)size.x * size.y * size.z;
+	std::vector<float> field(cellCount);
+	glGetTextureImage(distance.textureID, 0, GL_RED, GL_FLOAT, (GLsizei)(cellCount * sizeof(float)), field.data());
+
+	std::vector<std::uint8_t> occupied(cellCount, 0);
+	for (int z = 0; z < gridSize.z; ++z)
+	{
+		for (int y = 0; y < gridSize.y; ++y)
+		{
+			for (int x = 0; x < gridSize.x; ++x)
+			{
+				if (voxels[4 * (((std::size_t)z * gridSize.y + y) * gridSize.x + x) + 3] == 0)
+					continue;
+				const glm::ivec3 cell = glm::ivec3(x, y, z) / CELL_SIZE;
+				occupied[((std::size_t)cell.z * size.y + cell.y) * size.x + cell.x] = 1;
+			}
+		}
+	}
+
+	const std::vector<float> reference = computeReference(occupied, size);
+
+	// Jump flooding can only pick a seed farther than the nearest one, which is what makes skipping unsafe
+	double errorSum = 0.0;
+	float maxError = 0.f;
+	std::size_t overestimated = 0;
+	for (std::size_t i = 0; i < cellCount; ++i)
+	{
+		const float error = field[i] - reference[i];
+		errorSum += std::abs(error);
+		maxError = std::max(maxError, std::abs(error));
+		// Half float keeps about three significant digits
+		if (error > 0.01f * reference[i] + 0.01f)
+			++overestimated;
+	}
+
+	os << "Distance field " << size.x << "x" << size.y << "x" << size.z
+		<< ": mean error " << errorSum / cellCount << " cells, max error " << maxError
+		<< " cells, " << overestimated << " of " << cellCount << " cells farther than the reference" << std::endl;
+}
+
+std::vector<float> VoxelDistanceField::computeReference(const std::vector<std::uint8_t>& occupied, glm::ivec3 size)
+{
+	const std::size_t count = (std::size_t)size.x * size.y * size.z;
+	std::vector<float> squared(count);
+	for (std::size_t i = 0; i < count; ++i)
+		squared[i] = occupied[i] != 0 ? 0.f : INF;
+
+	const int longest = std::max({ size.x, size.y, size.z });
+	std::vector<float> f(longest), d(longest), z(longest + 1);
+	std::vector<int> v(longest);
+
+	// One pass per axis over every line of cells along it
+	const std::size_t strides[3] = { 1, (std::size_t)size.x, (std::size_t)size.x * size.y };
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const int n = size[axis];
+		const int u = (axis + 1) % 3;
+		const int w = (axis + 2) % 3;
+		for (int a = 0; a < size[u]; ++a)
+		{
+			for (int b = 0; b < size[w]; ++b)
+			{
+				const std::size_t start = a * strides[u] + b * strides[w];
+				for (int q = 0; q < n; ++q)
+					f[q] = squared[start + q * strides[axis]];
+				distanceTransform1D(f.data(), d.data(), n, v, z);
+				for (int q = 0; q < n; ++q)
+					squared[start + q * strides[axis]] = d[q];
+			}
+		}
+	}
+
+	std::vector<float> distance(count);
+	for (std::size_t i = 0; i < count; ++i)
+		distance[i] = squared[i] >= INF ? NO_GEOMETRY : std::min(std::sqrt(squared[i]), NO_GEOMETRY);
+	return distance;
+}
+
+glm::ivec3 VoxelDistanceField::getSize() const
+{
+	return size;
+}
@@ -0,0 +1,87 @@
+/**
+* @file	VoxelDistanceField.h
+* @date	2026-10-19
+* @brief	Distance from every cell of a voxel grid to the nearest geometry
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Texture3D.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Builds an empty space distance field from a geometry volume with jump flooding.
+ *
+ * The field has one cell per CELL_SIZE^3 voxels and holds the Euclidean distance in cells
+ * from each cell centre to the centre of the nearest cell holding geometry. Cones may skip
+ * the distance minus sqrt(3) cells, the most that two points in two cells can be closer
+ * than the cells' centres. Jump flooding is followed by an extra pass of step one (JFA+1),
+ * which removes most of the rare cells jump flooding assigns a seed that is not the nearest.
+ */
+class VoxelDistanceField
+{
+public:
+	static const int CELL_SIZE = 2;
+
+	// Distance written where the grid holds no geometry at all
+	static constexpr float NO_GEOMETRY = 10000.f;
+
+	VoxelDistanceField() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param gridSize Dimensions of the geometry volume, each cell covers CELL_SIZE voxels per axis.
+	 */
+	explicit VoxelDistanceField(glm::ivec3 gridSize);
+
+	~VoxelDistanceField();
+
+	VoxelDistanceField(const VoxelDistanceField&) = delete;
+	VoxelDistanceField& operator=(const VoxelDistanceField&) = delete;
+
+	/**
+	 * @brief Builds the distance field of a geometry volume.
+	 * @param geometry Geometry volume with coverage in alpha of level 0.
+	 * @param distance GL_R16F texture of getSize() receiving the distances in cells.
+	 */
+	void build(const Texture3D& geometry, const Texture3D& distance);
+
+	/**
+	 * @brief Compares a built field against computeReference and writes the errors. Reads both textures back.
+	 * @param geometry Geometry volume the field was built from.
+	 * @param distance Field built by build().
+	 * @param os Stream to write to.
+	 */
+	void validate(const Texture3D& geometry, const Texture3D& distance, std::ostream& os) const;
+
+	/**
+	 * @brief Exact Euclidean distance transform on the CPU, separable per axis (Felzenszwalb and Huttenlocher).
+	 * @param occupied One value per cell, x fastest, non-zero where the cell holds geometry.
+	 * @param size Dimensions of the field.
+	 * @return Distance in cells from every cell to the nearest occupied one, NO_GEOMETRY if there is none.
+	 */
+	static std::vector<float> computeReference(const std::vector<std::uint8_t>& occupied, glm::ivec3 size);
+
+	/**
+	 * @brief Gets the dimensions of the field in cells.
+	 */
+	glm::ivec3 getSize() const;
+
+private:
+	glm::ivec3 size;
+
+	/**
+	 * @brief Nearest seed cell of every cell, ping-ponged between flood passes
+	 */
+	Texture3D* seeds[2];
+
+	ShaderProgram seedShader;
+	ShaderProgram floodShader;
+	ShaderProgram resolveShader;
+};
@@ -0,0 +1,52 @@
+/**
+* @file	VoxelFormat.cpp
+* @date	2026-10-19
+* @brief	Storage formats for the radiance voxel grid
+*/
+
+#include "VoxelFormat.h"
+
+GLenum getVoxelInternalFormat(VOXEL_FORMAT format)
+{
+	switch (format)
+	{
+	case VOXEL_FORMAT::R11G11B10F:
+		return GL_R11F_G11F_B10F;
+	case VOXEL_FORMAT::RGBA16F:
+		return GL_RGBA16F;
+	default:
+		return GL_RGBA8;
+	}
+}
+
+std::string getVoxelImageFormat(VOXEL_FORMAT format)
+{
+	switch (format)
+	{
+	case VOXEL_FORMAT::R11G11B10F:
+		return "r11f_g11f_b10f";
+	case VOXEL_FORMAT::RGBA16F:
+		return "rgba16f";
+	default:
+		return "rgba8";
+	}
+}
+
+bool hasSeparateVoxelOpacity(VOXEL_FORMAT format)
+{
+	return format == VOXEL_FORMAT::R11G11B10F;
+}
+
+bool isVoxelFormatHDR(VOXEL_FORMAT format)
+{
+	return format != VOXEL_FORMAT::RGBA8;
+}
+
+void addVoxelFormatDefines(ShaderProgram& shader, VOXEL_FORMAT format)
+{
+	shader.addDefine("VOXEL_FORMAT", getVoxelImageFormat(format));
+	if (isVoxelFormatHDR(format))
+		shader.addDefine("VOXEL_HDR");
+	if (hasSeparateVoxelOpacity(format))
+		shader.addDefine("VOXEL_OPACITY_VOLUME");
+}
@@ -0,0 +1,74 @@
+/**
+* @file	VoxelFormat.h
+* @date	2026-10-19
+* @brief	Storage formats for the radiance voxel grid
+*/
+
+#pragma once
+
+#include <string>
+
+#include <GL/glew.h>
+
+#include "ShaderProgram.h"
+
+/**
+ * @brief Storage format of the radiance grid and its mip chains.
+ *
+ * Memory for the grid with its mip chain plus the six half resolution
+ * anisotropic volumes with theirs, and bytes fetched per trilinear sample:
+ *
+ *   Format               Bytes/voxel   128^3      256^3      Bytes/sample   Range and precision
+ *   RGBA8                4             16 MiB     128 MiB    32             [0, 1], 8 bit, saturates
+ *   R11G11B10F + R8      4 + 1         20 MiB     160 MiB    32 + 8         HDR, 6/6/5 bit mantissa
+ *   RGBA16F              8             32 MiB     256 MiB    64             HDR, 10 bit mantissa
+ *   RGB9E5 + R8          4 + 1         20 MiB     160 MiB    32 + 8         HDR, 9 bit shared exponent
+ *
+ * RGB9E5 is not offered: it is not an image load/store format, and light injection
+ * and the mip builders write the grid with imageStore. Formats without an alpha
+ * channel keep opacity in a separate R8 volume, which the shaders pick up through
+ * the VOXEL_OPACITY_VOLUME define. The four geometry volumes from voxelization
+ * (albedo, normal, emissive, ambient) stay RGBA8 since atomic averaging aliases them
+ * as R32UI. They hold level 0 only and add 4 x 8 MiB at 128^3.
+ */
+enum class VOXEL_FORMAT
+{
+	RGBA8,
+	R11G11B10F,
+	RGBA16F
+};
+
+/**
+ * @brief Gets the OpenGL internal format for the radiance grid.
+ * @param format Voxel format.
+ * @return Sized internal format.
+ */
+GLenum getVoxelInternalFormat(VOXEL_FORMAT format);
+
+/**
+ * @brief Gets the GLSL image format layout qualifier for the radiance grid.
+ * @param format Voxel format.
+ * @return Layout qualifier, e.g. "rgba16f".
+ */
+std::string getVoxelImageFormat(VOXEL_FORMAT format);
+
+/**
+ * @brief Whether opacity is kept in a separate R8 volume.
+ * @param format Voxel format.
+ * @return True if the format has no alpha channel.
+ */
+bool hasSeparateVoxelOpacity(VOXEL_FORMAT format);
+
+/**
+ * @brief Whether the format stores radiance above 1.
+ * @param format Voxel format.
+ * @return True for floating point formats.
+ */
+bool isVoxelFormatHDR(VOXEL_FORMAT format);
+
+/**
+ * @brief Adds VOXEL_FORMAT, VOXEL_HDR and VOXEL_OPACITY_VOLUME defines for the format to a shader.
+ * @param shader Shader to add the defines to, before compiling.
+ * @param format Voxel format.
+ */
+void addVoxelFormatDefines(ShaderProgram& shader, VOXEL_FORMAT format);
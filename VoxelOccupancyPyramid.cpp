@@ -0,0 +1,55 @@
+/**
+* @file	VoxelOccupancyPyramid.cpp
+* @date	2026-10-19
+* @brief	Conservative occupancy of a voxel grid at every mip level
+*/
+
+#include "VoxelOccupancyPyramid.h"
+
+#include <algorithm>
+
+VoxelOccupancyPyramid::VoxelOccupancyPyramid(glm::ivec3 gridSize) :
+	size{ gridSize },
+	blocks{ gridSize.x, gridSize.y, gridSize.z, GL_R8 },
+	reduceShader{ "resc/shaders/occupancyReduceComp.shader" },
+	dilateShader{ "resc/shaders/occupancyDilateComp.shader" }
+{
+	for (ShaderProgram* shader : { &reduceShader, &dilateShader })
+	{
+		shader->compile();
+		shader->link();
+	}
+}
+
+void VoxelOccupancyPyramid::build(const Texture3D& geometry, const Texture3D& occupancy)
+{
+	geometry.bind(0);
+	reduceShader.uploadUniform("geometry", 0);
+
+	// Each level is reduced from the one below and dilated right away, the dilation only reads its own level
+	for (int level = 0; level < blocks.getLevels(); ++level)
+	{
+		const glm::ivec3 levelSize = glm::max(size >> level, glm::ivec3(1));
+		const glm::ivec3 groups = (levelSize + 3) / 4;
+
+		reduceShader.uploadUniform("level", level);
+		if (level > 0)
+			glBindImageTexture(0, blocks.textureID, level - 1, GL_TRUE, 0, GL_READ_ONLY, GL_R8);
+		glBindImageTexture(1, blocks.textureID, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+		reduceShader.dispatch(groups.x, groups.y, groups.z);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		glBindImageTexture(0, blocks.textureID, level, GL_TRUE, 0, GL_READ_ONLY, GL_R8);
+		glBindImageTexture(1, occupancy.textureID, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+		dilateShader.dispatch(groups.x, groups.y, groups.z);
+	}
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+int VoxelOccupancyPyramid::getTopLevel() const
+{
+	int level = 0;
+	while ((4 << (level + 1)) <= std::min({ size.x, size.y, size.z }))
+		++level;
+	return std::min(level, blocks.getLevels() - 1);
+}
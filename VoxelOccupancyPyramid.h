@@ -0,0 +1,58 @@
+/**
+* @file	VoxelOccupancyPyramid.h
+* @date	2026-10-19
+* @brief	Conservative occupancy of a voxel grid at every mip level
+*/
+
+#pragma once
+
+#include "Texture3D.h"
+#include "ShaderProgram.h"
+
+/**
+ * @brief Builds a max-filtered occupancy pyramid for hierarchical empty space skipping.
+ *
+ * Level k of the pyramid has one texel per block of 2^k voxels per axis. A texel is zero only if
+ * its block and the blocks next to it hold no geometry, so every point within 2^k voxels of an
+ * empty block is empty as well. A cone sample whose trilinear footprint is at most that radius
+ * can then be skipped anywhere inside the block. Levels are reduced from a plain max pyramid,
+ * which is kept as scratch and dilated by one block per level into the target.
+ */
+class VoxelOccupancyPyramid
+{
+public:
+	VoxelOccupancyPyramid() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param gridSize Dimensions of the geometry volume and of level 0 of the pyramid.
+	 */
+	explicit VoxelOccupancyPyramid(glm::ivec3 gridSize);
+
+	VoxelOccupancyPyramid(const VoxelOccupancyPyramid&) = delete;
+	VoxelOccupancyPyramid& operator=(const VoxelOccupancyPyramid&) = delete;
+
+	/**
+	 * @brief Builds the dilated pyramid of a geometry volume.
+	 * @param geometry Geometry volume with coverage in alpha of level 0.
+	 * @param occupancy GL_R8 texture of the grid size with all mip levels, receiving the pyramid.
+	 */
+	void build(const Texture3D& geometry, const Texture3D& occupancy);
+
+	/**
+	 * @brief Gets the coarsest level worth testing, the one with blocks a quarter of the shortest grid axis.
+	 * Coarser levels are almost always occupied and would only add fetches.
+	 */
+	int getTopLevel() const;
+
+private:
+	glm::ivec3 size;
+
+	/**
+	 * @brief Occupancy of each block without its neighbours
+	 */
+	Texture3D blocks;
+
+	ShaderProgram reduceShader;
+	ShaderProgram dilateShader;
+};
@@ -0,0 +1,150 @@
+/**
+* @file	VoxelUpdateScheduler.cpp
+* @date	2026-10-19
+* @brief	Spreads voxel grid updates over several frames
+*/
+
+#include "VoxelUpdateScheduler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+VoxelUpdateScheduler::VoxelUpdateScheduler(int gridSize, int slabCount) :
+	gridSize{ gridSize },
+	slabCount{ slabCount },
+	slabSize{ (gridSize + slabCount - 1) / slabCount },
+	divisor{ 1 },
+	cursor{ 0 },
+	dirty(slabCount, true),
+	priority(slabCount, false),
+	voxelizeRanges{},
+	updateRanges{},
+	frames{ 0 },
+	slabsVoxelized{ 0 },
+	slabsUpdated{ 0 }
+{
+}
+
+void VoxelUpdateScheduler::setUpdateDivisor(int divisor)
+{
+	this->divisor = std::max(1, std::min(divisor, slabCount));
+}
+
+int VoxelUpdateScheduler::getUpdateDivisor() const
+{
+	return divisor;
+}
+
+void VoxelUpdateScheduler::markDirty(int zMin, int zMax)
+{
+	const int first = std::max(0, zMin / slabSize);
+	const int last = std::min(slabCount - 1, (zMax - 1) / slabSize);
+	for (int i = first; i <= last; ++i)
+		dirty[i] = true;
+}
+
+void VoxelUpdateScheduler::markPriority(int zMin, int zMax)
+{
+	const int first = std::max(0, zMin / slabSize);
+	const int last = std::min(slabCount - 1, (zMax - 1) / slabSize);
+	for (int i = first; i <= last; ++i)
+		priority[i] = true;
+}
+
+void VoxelUpdateScheduler::markAllDirty()
+{
+	std::fill(dirty.begin(), dirty.end(), true);
+}
+
+void VoxelUpdateScheduler::markAllClean()
+{
+	std::fill(dirty.begin(), dirty.end(), false);
+}
+
+void VoxelUpdateScheduler::schedule()
+{
+	int budget = (slabCount + divisor - 1) / divisor;
+	std::vector<bool> voxelize(slabCount, false);
+	std::vector<bool> update(slabCount, false);
+
+	// Changed geometry first, then dynamic objects
+	for (int i = 0; i < slabCount && budget > 0; ++i)
+	{
+		if (dirty[i])
+		{
+			voxelize[i] = update[i] = true;
+			dirty[i] = false;
+			--budget;
+		}
+	}
+	for (int i = 0; i < slabCount && budget > 0; ++i)
+	{
+		if (priority[i] && !update[i])
+		{
+			update[i] = true;
+			--budget;
+		}
+	}
+
+	// Fill the rest of the budget in round robin order
+	for (int visited = 0; visited < slabCount && budget > 0; ++visited)
+	{
+		if (!update[cursor])
+		{
+			update[cursor] = true;
+			--budget;
+		}
+		cursor = (cursor + 1) % slabCount;
+	}
+
+	std::fill(priority.begin(), priority.end(), false);
+
+	toRanges(voxelize, voxelizeRanges);
+	toRanges(update, updateRanges);
+
+	++frames;
+	slabsVoxelized += static_cast<int>(std::count(voxelize.begin(), voxelize.end(), true));
+	slabsUpdated += static_cast<int>(std::count(update.begin(), update.end(), true));
+}
+
+const std::vector<glm::ivec2>& VoxelUpdateScheduler::getVoxelizeRanges() const
+{
+	return voxelizeRanges;
+}
+
+const std::vector<glm::ivec2>& VoxelUpdateScheduler::getUpdateRanges() const
+{
+	return updateRanges;
+}
+
+void VoxelUpdateScheduler::report(std::ostream& os)
+{
+	if (frames == 0)
+		return;
+
+	os << std::setw(24) << std::left << "Voxel slabs per frame" << std::fixed << std::setprecision(2)
+		<< static_cast<float>(slabsVoxelized) / frames << " voxelized, "
+		<< static_cast<float>(slabsUpdated) / frames << " updated of " << slabCount
+		<< " (1/" << divisor << " budget)" << std::endl;
+
+	frames = 0;
+	slabsVoxelized = 0;
+	slabsUpdated = 0;
+}
+
+void VoxelUpdateScheduler::toRanges(const std::vector<bool>& selected, std::vector<glm::ivec2>& ranges) const
+{
+	ranges.clear();
+	for (int i = 0; i < slabCount; ++i)
+	{
+		if (!selected[i])
+			continue;
+
+		const int zMin = i * slabSize;
+		const int zMax = std::min(gridSize, (i + 1) * slabSize);
+		if (!ranges.empty() && ranges.back().y == zMin)
+			ranges.back().y = zMax;
+		else
+			ranges.emplace_back(zMin, zMax);
+	}
+}
@@ -0,0 +1,105 @@
+/**
+* @file	VoxelUpdateScheduler.h
+* @date	2026-10-19
+* @brief	Spreads voxel grid updates over several frames
+*/
+
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * @brief Round robin scheduler for slabs of the voxel grid.
+ *
+ * The grid is split into slabs along z. Each frame a budget of slabs is relit and
+ * refiltered: first slabs whose geometry changed, then slabs holding dynamic objects,
+ * then the remaining slabs in round robin order. Only slabs with changed geometry are
+ * re-voxelized. With an update divisor of 1 every slab is updated each frame.
+ */
+class VoxelUpdateScheduler
+{
+public:
+	VoxelUpdateScheduler() = delete;
+
+	/**
+	 * @brief Constructor
+	 * @param gridSize Size of the voxel grid along z.
+	 * @param slabCount Number of slabs the grid is split into.
+	 */
+	VoxelUpdateScheduler(int gridSize, int slabCount);
+
+	/**
+	 * @brief Sets how many frames a full update of the grid is spread over.
+	 * @param divisor 1 updates everything each frame, n updates 1/n of the slabs.
+	 */
+	void setUpdateDivisor(int divisor);
+
+	int getUpdateDivisor() const;
+
+	/**
+	 * @brief Marks the slabs overlapping a voxel z range as needing re-voxelization.
+	 * @param zMin First voxel layer.
+	 * @param zMax One past the last voxel layer.
+	 */
+	void markDirty(int zMin, int zMax);
+
+	/**
+	 * @brief Marks the slabs overlapping a voxel z range as holding dynamic objects this frame.
+	 * @param zMin First voxel layer.
+	 * @param zMax One past the last voxel layer.
+	 */
+	void markPriority(int zMin, int zMax);
+
+	/**
+	 * @brief Marks every slab as needing re-voxelization.
+	 */
+	void markAllDirty();
+
+	/**
+	 * @brief Marks every slab as voxelized, e.g. after the grid was loaded from disk.
+	 */
+	void markAllClean();
+
+	/**
+	 * @brief Picks the slabs to update this frame. Clears the priority marks.
+	 */
+	void schedule();
+
+	/**
+	 * @brief Voxel z ranges [x, y) to re-voxelize this frame, adjacent slabs merged.
+	 */
+	const std::vector<glm::ivec2>& getVoxelizeRanges() const;
+
+	/**
+	 * @brief Voxel z ranges [x, y) to relight and refilter this frame, adjacent slabs merged.
+	 */
+	const std::vector<glm::ivec2>& getUpdateRanges() const;
+
+	/**
+	 * @brief Writes the average number of slabs updated per frame since the last report and resets it.
+	 * @param os Stream to write to.
+	 */
+	void report(std::ostream& os);
+
+private:
+	// Converts a slab selection to merged voxel ranges
+	void toRanges(const std::vector<bool>& selected, std::vector<glm::ivec2>& ranges) const;
+
+	int gridSize;
+	int slabCount;
+	int slabSize;
+	int divisor;
+	int cursor;
+	std::vector<bool> dirty;
+	std::vector<bool> priority;
+	std::vector<glm::ivec2> voxelizeRanges;
+	std::vector<glm::ivec2> updateRanges;
+
+	// Telemetry
+	int frames;
+	int slabsVoxelized;
+	int slabsUpdated;
+};
@@ -0,0 +1,82 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+#ifndef VOXEL_FORMAT
+#define VOXEL_FORMAT rgba8
+#endif
+
+// The opacity pass writes blended coverage to the R8 opacity volumes instead of colour
+#ifdef VOXEL_OPACITY_PASS
+#define DIRECTIONAL_FORMAT r8
+#else
+#define DIRECTIONAL_FORMAT VOXEL_FORMAT
+#endif
+
+// Directional volumes in +X, -X, +Y, -Y, +Z, -Z order
+uniform sampler3D voxAniso[6];
+#ifdef VOXEL_OPACITY_VOLUME
+uniform sampler3D voxAnisoOpacity[6];
+#endif
+uniform int sourceLevel;
+
+// The level after sourceLevel of the same volumes
+layout(DIRECTIONAL_FORMAT, binding = 0) writeonly uniform image3D voxAnisoMip[6];
+
+// Region of the destination level to rebuild
+uniform ivec3 regionOffset;
+uniform ivec3 regionSize;
+
+// Front to back blending of two premultiplied voxels
+vec4 blend(vec4 front, vec4 back)
+{
+	return front + (1.f - front.a) * back;
+}
+
+// Reduces a 2x2x2 block (indexed x + 2y + 4z) as seen when travelling along direction dir
+vec4 reduce(vec4 v[8], int dir)
+{
+	const int axisStep = 1 << (dir / 2);
+	const bool positive = (dir % 2) == 0;
+
+	vec4 acc = vec4(0.f);
+	for (int i = 0; i < 8; ++i)
+	{
+		if ((i & axisStep) != 0)
+			continue;
+
+		// A cone travelling in positive direction meets the low coordinate first
+		acc += positive ? blend(v[i], v[i + axisStep]) : blend(v[i + axisStep], v[i]);
+	}
+	return 0.25f * acc;
+}
+
+vec4 fetchVoxel(int dir, ivec3 pos)
+{
+#ifdef VOXEL_OPACITY_VOLUME
+	return vec4(texelFetch(voxAniso[dir], pos, sourceLevel).rgb, texelFetch(voxAnisoOpacity[dir], pos, sourceLevel).r);
+#else
+	return texelFetch(voxAniso[dir], pos, sourceLevel);
+#endif
+}
+
+void main()
+{
+	if (any(greaterThanEqual(ivec3(gl_GlobalInvocationID), regionSize)))
+		return;
+
+	const ivec3 dst = regionOffset + ivec3(gl_GlobalInvocationID);
+
+	for (int dir = 0; dir < 6; ++dir)
+	{
+		vec4 v[8];
+		for (int i = 0; i < 8; ++i)
+			v[i] = fetchVoxel(dir, 2 * dst + ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+
+#ifdef VOXEL_OPACITY_PASS
+		imageStore(voxAnisoMip[dir], dst, vec4(reduce(v, dir).a));
+#else
+		imageStore(voxAnisoMip[dir], dst, reduce(v, dir));
+#endif
+	}
+}
@@ -1,5 +1,29 @@
 #version 450 core
 
+// Compile time features selected by CornellScene::getConeTracingFeatures, paths not taken are not compiled.
+// VIEW: 0 voxels, 1 direct light, 2 shadows, 3 indirect diffuse, 4 indirect specular, 5 all combined, 6 ambient occlusion
+#ifndef VIEW
+#define VIEW 5
+#endif
+// Ambient occlusion traced at reduced resolution darkens the ambient and indirect diffuse light
+#ifndef AMBIENT_OCCLUSION
+#define AMBIENT_OCCLUSION 0
+#endif
+// Passes tracing into a reduced resolution buffer rather than shading the screen
+#if defined(INDIRECT_DIFFUSE_PASS) || defined(AMBIENT_OCCLUSION_PASS)
+#define REDUCED_PASS
+#endif
+// Terms of the combined view
+#ifndef SPECULAR
+#define SPECULAR 1
+#endif
+#ifndef SHADOWS
+#define SHADOWS 1
+#endif
+
+// Depth is tested before the cone tracing runs, fragments behind the visible surface are never shaded
+layout(early_fragment_tests) in;
+
 struct Material
 {
 	vec3 ambient;
@@ -22,26 +46,152 @@ struct Light
 	float quadratic;
 };
 
+#ifdef DEFERRED
+// G-buffer: world position with the material index in w, world normal with coverage in w, texture colour
+layout(rgba32f, binding = 0) readonly uniform image2D gPosition;
+layout(rgba16f, binding = 1) readonly uniform image2D gNormal;
+layout(rgba8, binding = 2) readonly uniform image2D gColor;
+
+// Materials of all objects, indexed from the G-buffer
+layout(std430, binding = 1) readonly buffer Materials
+{
+	Material materials[];
+};
+
+// Surface of the pixel, read from the G-buffer at the start of main
+vec3 fragNorm;
+vec3 fragPos;
+Material material;
+#else
 in vec3 fragNorm;
 in vec3 fragPos;
 in vec2 texCoords;
 
-out vec4 fragColor;
-
-uniform int gridSize;
-uniform int Mode;
+uniform Material material;
+#endif
+
+layout(location = 0) out vec4 fragColor;
+#ifdef INDIRECT_DIFFUSE_PASS
+// Surface the irradiance was traced from, world normal and distance to the camera
+layout(location = 1) out vec4 diffuseSurface;
+// Screen position change since the previous frame, linear depth in the previous and the current frame
+layout(location = 2) out vec4 diffuseMotion;
+in vec4 currentClipPos;
+in vec4 previousClipPos;
+
+// Frame index rotating the diffuse cones about the normal, negative keeps them fixed
+uniform int coneFrame;
+#elif defined(AMBIENT_OCCLUSION_PASS)
+// Surface the visibility was traced from, world normal and distance to the camera
+layout(location = 1) out vec4 occlusionSurface;
+#else
+// Indirect diffuse irradiance traced at 1 / diffuseScale of the resolution and possibly accumulated over frames,
+// upsampled when reducedDiffuse is set
+layout(rgba16f, binding = 3) readonly uniform image2D diffuseIrradiance;
+layout(rgba32f, binding = 4) readonly uniform image2D diffuseSurfaces;
+uniform bool reducedDiffuse;
+uniform int diffuseScale;
+
+// Ambient visibility traced at 1 / occlusionScale of the resolution, upsampled when AMBIENT_OCCLUSION is set
+layout(r16f, binding = 5) readonly uniform image2D occlusionVisibility;
+layout(rgba32f, binding = 7) readonly uniform image2D occlusionSurfaces;
+uniform int occlusionScale;
+#endif
+
+// World distance the ambient occlusion cones reach
+uniform float occlusionRange;
+
+// World space to 0->1 coordinates of the voxel volume, and the edge length of a voxel
+uniform mat4 worldToVoxel;
+uniform float voxelWorldSize;
+uniform bool anisotropic;
 
 uniform vec3 view_pos;
 
-uniform Material material;
 uniform Light light;
 
 uniform sampler2D texUnit;
 uniform sampler3D voxGrid;
+uniform sampler3D voxAniso[6]; // +X, -X, +Y, -Y, +Z, -Z at half the grid resolution
+#ifdef VOXEL_OPACITY_VOLUME
+// Coverage of voxGrid and voxAniso for formats without alpha
+uniform sampler3D voxOpacity;
+uniform sampler3D voxAnisoOpacity[6];
+#endif
+
+// How empty space is skipped: 0 not at all, 1 with the distance field, 2 with the occupancy pyramid
+uniform int emptySpaceMode;
+
+// Distance in cells of emptySpaceCellSize voxels to the nearest geometry
+uniform sampler3D emptySpace;
+uniform int emptySpaceCellSize;
+
+// Zero at level k where a block of 2^k voxels and its neighbours are empty, see VoxelOccupancyPyramid
+uniform sampler3D occupancy;
+uniform int occupancyTopLevel;
+
+// Diffuse cones of the quality tier and where the schedule of each cone type starts, see ConeSet
+layout(std140, binding = 0) uniform ConeSet
+{
+	vec4 coneDirections[16]; // Tangent space, z along the normal, weight in w
+	int coneCount;
+	float coneAperture;
+	int diffuseSchedule;
+	int diffuseScheduleLength;
+	int specularSchedule;
+	int specularScheduleLength;
+	int shadowSchedule;
+	int shadowScheduleLength;
+};
+
+// Samples of every cone type: distance, mip level and step to the next sample
+layout(std430, binding = 2) readonly buffer ConeSchedules
+{
+	vec4 coneSchedule[];
+};
+
+// Per cone type: cones traced, marching steps summed and the most steps of one cone. Filled on frames that sample it
+layout(std430, binding = 0) buffer ConeSteps
+{
+	uvec4 coneSteps[3];
+};
+uniform bool countSteps;
+
+const int DIFFUSE_CONE = 0;
+const int SPECULAR_CONE = 1;
+const int SHADOW_CONE = 2;
+
+// Hard limit on the steps of one cone, whatever the volume and the schedules
+uniform int maxConeSteps;
+
+#ifdef STEP_HEATMAP
+// Per pixel: diffuse, specular and shadow steps, then voxel samples fetched, see StepHeatmap
+layout(r32ui, binding = 6) uniform uimage2DArray stepCounts;
+uint pixelSteps[3] = uint[3](0u, 0u, 0u);
+uint voxelFetches = 0u;
+#endif
+
+// Step and offset unit, tuned for a volume spanning -1->1 where it was 1 / gridSize
+float voxelSize;
+
+vec3 toVoxel(vec3 pos)
+{
+	return (worldToVoxel * vec4(pos, 1.f)).xyz;
+}
 
-float voxelSize = 1.f / gridSize;
-float MAX_DISTANCE = distance(vec3(abs(fragPos)), vec3(-1.f));
-vec3 fragNormNorm = normalize(fragNorm);
+vec3 fragVoxelPos;
+vec3 fragNormNorm;
+
+// Upsampled ambient occlusion of the pixel, 1 without AMBIENT_OCCLUSION
+float ambientVisibility = 1.f;
+
+// Sets the values derived from the surface, once it is known
+void initSurface()
+{
+	voxelSize = 0.5f * voxelWorldSize;
+	fragVoxelPos = toVoxel(fragPos);
+	fragNormNorm = normalize(fragNorm);
+}
 
 float calculateAttenuation(float dist)
 {
@@ -54,32 +204,195 @@ vec3 findOrthVec(vec3 u) {
 	return abs(dot(u, v)) > 0.99999f ? cross(u, vec3(0, 1, 0)) : cross(u, v);
 }
 
-bool outOfBounds(const vec3 pos)
-{ 
-	return abs(pos.x) > 1 || abs(pos.y) > 1 || abs(pos.z) > 1;
+// Distances along the normalized dir at which a ray from from enters and leaves the volume (slab test).
+// Entry is at least 0, a ray missing the volume gets an exit before its entry
+vec2 clipToVolume(vec3 from, vec3 dir)
+{
+	const vec3 origin = toVoxel(from);
+	vec3 direction = mat3(worldToVoxel) * dir;
+	direction += vec3(equal(direction, vec3(0.f))) * 1e-8f;
+
+	const vec3 t0 = -origin / direction;
+	const vec3 t1 = (vec3(1.f) - origin) / direction;
+	const vec3 tNear = min(t0, t1);
+	const vec3 tFar = max(t0, t1);
+	return vec2(max(max(tNear.x, tNear.y), max(tNear.z, 0.f)), min(min(tFar.x, tFar.y), tFar.z));
+}
+
+// World distance from pos to the nearest voxel holding geometry, or less
+float emptySpaceDistance(vec3 pos)
+{
+	const ivec3 size = textureSize(emptySpace, 0);
+	const ivec3 cell = clamp(ivec3(toVoxel(pos) * vec3(size)), ivec3(0), size - 1);
+
+	// Points of two cells can be up to a cell diagonal closer than their centres
+	return (texelFetch(emptySpace, cell, 0).r - 1.75f) * voxelWorldSize * float(emptySpaceCellSize);
+}
+
+// Mip level of a cone at distance t, lodBias + lodScale * log2(1 + spread * t / voxelSize), as far as the volume goes
+float coneLod(float t, float lodBias, float lodScale, float spread)
+{
+	return min(lodBias + lodScale * log2(1.f + spread * t / voxelSize), 6.f);
+}
+
+// World distance along the normalized dir from pos to where it leaves the coarsest empty block of the
+// occupancy pyramid that is safe to cross. Descends from the top level towards geometry like a hierarchical DDA.
+// A sample at level l reads up to 2^(l + 1) voxels away, within the dilation of a block of level l + 1 or coarser
+float occupancySkip(vec3 pos, vec3 dir, float dist, float lodBias, float lodScale, float spread)
+{
+	const ivec3 gridSize = textureSize(occupancy, 0);
+	const vec3 voxel = toVoxel(pos) * vec3(gridSize);
+	vec3 voxelDir = mat3(worldToVoxel) * dir * vec3(gridSize);
+	voxelDir += vec3(equal(voxelDir, vec3(0.f))) * 1e-8f;
+
+	for (int level = occupancyTopLevel; level > 0; --level)
+	{
+		const ivec3 size = textureSize(occupancy, level);
+		const ivec3 block = clamp(ivec3(voxel) >> level, ivec3(0), size - 1);
+		if (texelFetch(occupancy, block, level).r > 0.f)
+			continue;
+
+		// The last block of an axis reaches the end of the grid, levels are rounded down
+		const vec3 blockMin = vec3(block << level);
+		const vec3 blockMax = mix(vec3((block + 1) << level), vec3(gridSize), equal(block, size - 1));
+		const vec3 exits = (mix(blockMin, blockMax, greaterThan(voxelDir, vec3(0.f))) - voxel) / voxelDir;
+		const float exitDist = max(min(min(exits.x, exits.y), exits.z), 0.f);
+		if (coneLod(dist + exitDist, lodBias, lodScale, spread) + 1.f <= float(level))
+			return exitDist;
+	}
+	return 0.f;
+}
+
+// How far a cone at dist can jump past empty space without skipping a sample that would reach geometry.
+// Its mip level at distance t is coneLod(t, lodBias, lodScale, spread), the farthest level reached bounds
+// the footprint of every skipped sample.
+float emptySpaceSkip(vec3 pos, vec3 dir, float dist, float lodBias, float lodScale, float spread)
+{
+	if (emptySpaceMode == 2)
+		return occupancySkip(pos, dir, dist, lodBias, lodScale, spread);
+	if (emptySpaceMode != 1)
+		return 0.f;
+
+	const float empty = emptySpaceDistance(pos);
+	if (empty <= 0.f)
+		return 0.f;
+
+	return empty - voxelWorldSize * exp2(coneLod(dist + empty, lodBias, lodScale, spread) + 1.f);
+}
+
+void recordSteps(int type, int steps)
+{
+#ifdef STEP_HEATMAP
+	pixelSteps[type] += uint(steps);
+#endif
+	if (countSteps)
+	{
+		atomicAdd(coneSteps[type].x, 1u);
+		atomicAdd(coneSteps[type].y, uint(steps));
+		atomicMax(coneSteps[type].z, uint(steps));
+	}
+}
+
+// Samples the voxel grid with opacity in alpha
+vec4 sampleGrid(vec3 pos, float lod)
+{
+#ifdef STEP_HEATMAP
+#ifdef VOXEL_OPACITY_VOLUME
+	voxelFetches += 2u;
+#else
+	++voxelFetches;
+#endif
+#endif
+#ifdef VOXEL_OPACITY_VOLUME
+	return vec4(textureLod(voxGrid, pos, lod).rgb, textureLod(voxOpacity, pos, lod).r);
+#else
+	return textureLod(voxGrid, pos, lod);
+#endif
+}
+
+// Samples one directional volume with opacity in alpha
+vec4 sampleDirection(int dir, vec3 pos, float lod)
+{
+#ifdef STEP_HEATMAP
+#ifdef VOXEL_OPACITY_VOLUME
+	voxelFetches += 2u;
+#else
+	++voxelFetches;
+#endif
+#endif
+#ifdef VOXEL_OPACITY_VOLUME
+	return vec4(textureLod(voxAniso[dir], pos, lod).rgb, textureLod(voxAnisoOpacity[dir], pos, lod).r);
+#else
+	return textureLod(voxAniso[dir], pos, lod);
+#endif
+}
+
+// Samples the directional volumes facing a cone travelling along dir, weighted by dir
+vec4 sampleAnisotropic(vec3 pos, vec3 dir, float lod)
+{
+	const vec3 weight = dir * dir;
+	const vec4 x = dir.x > 0.f ? sampleDirection(0, pos, lod) : sampleDirection(1, pos, lod);
+	const vec4 y = dir.y > 0.f ? sampleDirection(2, pos, lod) : sampleDirection(3, pos, lod);
+	const vec4 z = dir.z > 0.f ? sampleDirection(4, pos, lod) : sampleDirection(5, pos, lod);
+	return weight.x * x + weight.y * y + weight.z * z;
+}
+
+// Samples the voxel grid at texture position pos for a cone travelling along the normalized dir
+vec4 sampleVoxels(vec3 pos, vec3 dir, float lod)
+{
+	if (!anisotropic)
+		return sampleGrid(pos, lod);
+
+	// Level 0 of the directional volumes corresponds to level 1 of the grid
+	if (lod < 1.f)
+		return mix(sampleGrid(pos, 0.f), sampleAnisotropic(pos, dir, 0.f), lod);
+	return sampleAnisotropic(pos, dir, lod - 1.f);
+}
+
+// Index of the last scheduled sample closer than dist, the loop increment moves on to the first one past it
+int skipSchedule(int i, int end, float dist)
+{
+	while (i + 1 < end && coneSchedule[i + 1].x < dist)
+		++i;
+	return i;
+}
+
+// Index of the first scheduled sample at dist or farther
+int firstScheduled(int begin, int end, float dist)
+{
+	return skipSchedule(begin - 1, end, dist) + 1;
 }
 
 vec3 castSpecularCone(vec3 from, vec3 dir) {
 	dir = normalize(dir);
 
 	const float offset = 2 * voxelSize;
-	const float distStep = voxelSize;
-
 	from += offset * fragNormNorm;
-	float dist = offset;
+
+	const vec2 span = clipToVolume(from, dir);
 
 	vec4 acc = vec4(0.0f);
-	while (dist < MAX_DISTANCE && acc.a < 1.f) {
-		vec3 curGridPos = from + dist * dir;
-		if (outOfBounds(curGridPos)) break;
+	int steps = 0;
+	const int end = specularSchedule + specularScheduleLength;
+	for (int i = firstScheduled(specularSchedule, end, span.x); i < end && acc.a < 1.f && steps < maxConeSteps; ++i) {
+		const vec4 entry = coneSchedule[i];
+		if (entry.x >= span.y) break;
 
-		float MMlevel = 0.1 * log2(1 + dist / voxelSize);
-		vec4 voxel = textureLod(voxGrid, 0.5f * curGridPos + vec3(0.5f), min(MMlevel, 6.f));
+		++steps;
+		vec3 curGridPos = from + entry.x * dir;
+
+		const float skip = emptySpaceSkip(curGridPos, dir, entry.x, 0.f, 0.1f, 1.f);
+		if (skip > entry.z) {
+			i = skipSchedule(i, end, entry.x + skip);
+			continue;
+		}
+
+		vec4 voxel = sampleVoxels(toVoxel(curGridPos), dir, entry.y);
 
 		acc.rgb += 0.6 * voxel.rgb * (1 - acc.a);
 		acc.a += 0.6 * voxel.a;
-		dist += distStep * (1.0f + 0.15f * MMlevel);
 	}
+	recordSteps(SPECULAR_CONE, steps);
 	return 1.0 * acc.rgb;
 }
 
@@ -87,21 +400,28 @@ vec3 castDiffuseCone(vec3 from, vec3 dir)
 {
 	dir = normalize(dir);
 
-	const float spread = 0.35;
+	const vec2 span = clipToVolume(from, dir);
 
 	vec4 acc = vec4(0.0f);
-	float dist = 0.05;
-	vec3 curGridPos = from;
-	while (dist < MAX_DISTANCE && acc.a < 1) {
-		curGridPos = from + dist * dir;
-
-		float l = (1 + spread * dist / voxelSize);
-		float MMlevel = log2(l);
-
-		vec4 voxel = textureLod(voxGrid, vec3(0.5f) + 0.5f * curGridPos, min(6, MMlevel));
+	int steps = 0;
+	const int end = diffuseSchedule + diffuseScheduleLength;
+	for (int i = firstScheduled(diffuseSchedule, end, span.x); i < end && acc.a < 1 && steps < maxConeSteps; ++i) {
+		const vec4 entry = coneSchedule[i];
+		if (entry.x >= span.y) break;
+
+		++steps;
+		const vec3 curGridPos = from + entry.x * dir;
+
+		const float skip = emptySpaceSkip(curGridPos, dir, entry.x, 0.f, 1.f, coneAperture);
+		if (skip > entry.z) {
+			i = skipSchedule(i, end, entry.x + skip);
+			continue;
+		}
+
+		vec4 voxel = sampleVoxels(toVoxel(curGridPos), dir, entry.y);
 		acc += 0.3 * voxel * pow(1 - voxel.a, 2);
-		dist += MMlevel * voxelSize * 3;
 	}
+	recordSteps(DIFFUSE_CONE, steps);
 	return pow(acc.rgb * 2.0, vec3(1.5));
 }
 
@@ -113,41 +433,84 @@ float castShadowCone()
 	dir = normalize(dir);
 
 	const float offset = 2 * voxelSize;
-	const float distStep = voxelSize;
-
 	vec3 from = fragPos + offset * fragNormNorm;
-	float dist = offset;
+
+	const vec2 span = clipToVolume(from, dir);
+	const float exitDist = min(span.y, travelDist);
 
 	float shadowAcc = 0.f;
-	vec3 curGridPos = from + dist * dir;
-	while (dist < travelDist && shadowAcc < 1.f) {
-		curGridPos = from + dist * dir;
-		if (outOfBounds(curGridPos)) break;
-		float MMlevel = 0.6 * log2(1 + dist / voxelSize);
+	int steps = 0;
+	const int end = shadowSchedule + shadowScheduleLength;
+	for (int i = firstScheduled(shadowSchedule, end, span.x); i < end && shadowAcc < 1.f && steps < maxConeSteps; ++i) {
+		const vec4 entry = coneSchedule[i];
+		if (entry.x >= exitDist) break;
 
-		vec4 voxel1 = textureLod(voxGrid, 0.5f * curGridPos + vec3(0.5f), min(1.f + MMlevel, 6.f));
-		vec4 voxel2 = textureLod(voxGrid, 0.5f * curGridPos + vec3(0.5f), 0.3f * min(1.f + MMlevel, 2.f));
+		++steps;
+		const vec3 curGridPos = from + entry.x * dir;
 
-		shadowAcc += 0.034f * voxel1.a + 0.09f * voxel2.a;
+		const float skip = emptySpaceSkip(curGridPos, dir, entry.x, 1.f, 0.6f, 1.f);
+		if (skip > entry.z) {
+			i = skipSchedule(i, end, entry.x + skip);
+			continue;
+		}
 
-		dist += distStep * (1.0f + 0.15f * MMlevel) / 2;
+		vec4 voxel1 = sampleVoxels(toVoxel(curGridPos), dir, min(1.f + entry.y, 6.f));
+		vec4 voxel2 = sampleVoxels(toVoxel(curGridPos), dir, 0.3f * min(1.f + entry.y, 2.f));
+
+		shadowAcc += 0.034f * voxel1.a + 0.09f * voxel2.a;
 	}
+	recordSteps(SHADOW_CONE, steps);
 
 	return pow(0.7f * max(1.f - shadowAcc + 0.2f * noise1(fragPos.x), 0.f), 0.8);
 }
 
+// Visibility of the hemisphere over the surface, 1 where nothing occludes. Four short cones read
+// opacity only, and at most mip level 3 as they never leave the neighbourhood of the surface.
+// Sampled like the other cones, the isotropic grid has no mips while the directional volumes are built
+float ambientOcclusion()
+{
+	const vec3 orth = normalize(findOrthVec(fragNormNorm));
+	const vec3 orth2 = normalize(cross(orth, fragNormNorm));
+	const vec3 from = fragPos + voxelWorldSize * fragNormNorm;
+	const float aperture = 0.7f;
+
+	float visibility = 0.f;
+	for (int i = 0; i < 4; ++i)
+	{
+		const float angle = 1.570796f * float(i) + 0.785398f;
+		const vec3 dir = normalize(0.7071f * (cos(angle) * orth + sin(angle) * orth2) + 0.7071f * fragNormNorm);
+		const float end = min(occlusionRange, clipToVolume(from, dir).y);
+
+		float occlusion = 0.f;
+		for (float dist = voxelWorldSize; dist < end && occlusion < 1.f; )
+		{
+			const float diameter = max(2.f * aperture * dist, voxelWorldSize);
+			const float lod = min(log2(diameter / voxelWorldSize), 3.f);
+			const float opacity = sampleVoxels(toVoxel(from + dist * dir), dir, lod).a;
+
+			// Fades out towards the range, so the cut-off leaves no edge
+			occlusion += (1.f - occlusion) * opacity * (1.f - dist / occlusionRange);
+			dist += 0.5f * diameter;
+		}
+		visibility += 0.25f * (1.f - min(occlusion, 1.f));
+	}
+	return visibility;
+}
+
 vec3 indirectSpecularLight() 
 {
 	const vec3 viewDir = normalize(fragPos - view_pos);
 	const vec3 reflection = normalize(reflect(viewDir, fragNormNorm));
 
-	if (Mode == 4)
-		return 0.8f * material.specular * castSpecularCone(fragPos, reflection);
-	else 
-		return 0.8f * material.specular * material.specularReflectivity * castSpecularCone(fragPos, reflection);
+#if VIEW == 4
+	return 0.8f * material.specular * castSpecularCone(fragPos, reflection);
+#else
+	return 0.8f * material.specular * material.specularReflectivity * castSpecularCone(fragPos, reflection);
+#endif
 }
 
-vec3 indirectDiffuseLight()
+// Diffuse irradiance gathered by the cones, without the response of the surface
+vec3 indirectDiffuseIrradiance()
 {
 	// Find a orthonormal base from frag normal 
 	const vec3 orth = normalize(findOrthVec(fragNormNorm));
@@ -159,23 +522,118 @@ vec3 indirectDiffuseLight()
 
 	vec3 acc = vec3(0);
 
-	// front cone
-	acc += castDiffuseCone(from, fragNormNorm);
+	// While accumulating over frames the set rotates about the normal by the golden angle, interleaved
+	// over 2x2 pixels, so the gaps between its cones get covered
+	float angle = 0.f;
+#ifdef INDIRECT_DIFFUSE_PASS
+	if (coneFrame >= 0)
+	{
+		const ivec2 interleave = ivec2(gl_FragCoord.xy) & 1;
+		angle = 2.39996f * float(coneFrame) + 0.785398f * float(interleave.x + 2 * interleave.y);
+	}
+#endif
+	const vec3 tangent = cos(angle) * orth + sin(angle) * orth2;
+	const vec3 bitangent = cos(angle) * orth2 - sin(angle) * orth;
+
+	for (int i = 0; i < coneCount; ++i)
+	{
+		const vec4 cone = coneDirections[i];
+		acc += cone.w * castDiffuseCone(from, cone.x * tangent + cone.y * bitangent + cone.z * fragNormNorm);
+	}
+
+	// Return result. The power of a product splits, so the albedo can be applied at full resolution
+	return 0.7f * pow(1.1f * acc, vec3(0.9f));
+}
+
+vec3 diffuseResponse()
+{
+	return pow(material.diffuse * material.diffuseReflectivity, vec3(0.9f));
+}
 
-	// 4 side cones
-	acc += castDiffuseCone(from, orth);
-	acc += castDiffuseCone(from, -orth);
-	acc += castDiffuseCone(from, orth2);
-	acc += castDiffuseCone(from, -orth2);
+#ifndef REDUCED_PASS
+// Joint bilateral weight of a reduced sample: bilinear, and how well its surface matches this pixel in
+// distance to the camera and normal. Zero where the sample hit nothing
+float bilateralWeight(vec4 surface, float bilinear, float depth)
+{
+	if (surface.w == 0.f)
+		return 0.f;
 
-	// Return result.
-	return 0.7f * pow(1.1f * acc * material.diffuse * material.diffuseReflectivity, vec3(0.9f));
+	const float depthWeight = exp(-abs(surface.w - depth) / (0.02f * depth));
+	const float normalWeight = pow(max(dot(surface.xyz, fragNormNorm), 0.f), 8.f);
+	return max(bilinear, 1e-3f) * depthWeight * normalWeight;
+}
+
+// Joint bilateral upsampling of the four nearest reduced samples
+vec3 upsampleIndirectDiffuse()
+{
+	const ivec2 size = imageSize(diffuseIrradiance);
+	const vec2 reducedPos = gl_FragCoord.xy / float(diffuseScale) - 0.5f;
+	const ivec2 base = ivec2(floor(reducedPos));
+	const vec2 f = reducedPos - vec2(base);
+	const float depth = distance(fragPos, view_pos);
+
+	vec3 sum = vec3(0.f);
+	float weightSum = 0.f;
+	for (int y = 0; y < 2; ++y)
+	{
+		for (int x = 0; x < 2; ++x)
+		{
+			const ivec2 texel = clamp(base + ivec2(x, y), ivec2(0), size - 1);
+			const float bilinear = (x == 1 ? f.x : 1.f - f.x) * (y == 1 ? f.y : 1.f - f.y);
+			const float weight = bilateralWeight(imageLoad(diffuseSurfaces, texel), bilinear, depth);
+			sum += weight * imageLoad(diffuseIrradiance, texel).rgb;
+			weightSum += weight;
+		}
+	}
+
+	// No reduced sample lies on this surface, typically a thin edge: trace it at full resolution
+	if (weightSum < 1e-4f)
+		return indirectDiffuseIrradiance();
+	return sum / weightSum;
+}
+
+// Joint bilateral upsampling of the ambient visibility, like upsampleIndirectDiffuse
+float upsampleAmbientOcclusion()
+{
+	const ivec2 size = imageSize(occlusionVisibility);
+	const vec2 reducedPos = gl_FragCoord.xy / float(occlusionScale) - 0.5f;
+	const ivec2 base = ivec2(floor(reducedPos));
+	const vec2 f = reducedPos - vec2(base);
+	const float depth = distance(fragPos, view_pos);
+
+	float sum = 0.f;
+	float weightSum = 0.f;
+	for (int y = 0; y < 2; ++y)
+	{
+		for (int x = 0; x < 2; ++x)
+		{
+			const ivec2 texel = clamp(base + ivec2(x, y), ivec2(0), size - 1);
+			const float bilinear = (x == 1 ? f.x : 1.f - f.x) * (y == 1 ? f.y : 1.f - f.y);
+			const float weight = bilateralWeight(imageLoad(occlusionSurfaces, texel), bilinear, depth);
+			sum += weight * imageLoad(occlusionVisibility, texel).r;
+			weightSum += weight;
+		}
+	}
+
+	if (weightSum < 1e-4f)
+		return ambientOcclusion();
+	return sum / weightSum;
+}
+#endif
+
+vec3 indirectDiffuseLight()
+{
+#ifndef REDUCED_PASS
+	if (reducedDiffuse)
+		return ambientVisibility * upsampleIndirectDiffuse() * diffuseResponse();
+#endif
+	return ambientVisibility * indirectDiffuseIrradiance() * diffuseResponse();
 }
 
 vec3 directLight()
 {
 	// Ambient color calculation
-	vec3 ambient = light.ambient*material.ambient;
+	vec3 ambient = ambientVisibility * light.ambient*material.ambient;
 
 	// Diffuse color calculation
 	vec3 light_dir = normalize(light.position - fragPos);
@@ -198,19 +656,65 @@ vec3 directLight()
 
 void main()
 {
+#ifdef DEFERRED
+	const ivec2 pixel = ivec2(gl_FragCoord.xy);
+	const vec4 normalCoverage = imageLoad(gNormal, pixel);
+	if (normalCoverage.w == 0.f)
+		discard;
+
+	const vec4 positionMaterial = imageLoad(gPosition, pixel);
+	fragPos = positionMaterial.xyz;
+	fragNorm = normalCoverage.xyz;
+	material = materials[int(positionMaterial.w)];
+	vec4 objColor = imageLoad(gColor, pixel);
+#else
 	vec4 objColor = texture(texUnit, texCoords);
-
-	if (Mode == 0)
-		fragColor.bgra = textureLod(voxGrid, 0.5f*(fragPos)+vec3(0.5f), 0.f);
-	else if (Mode == 1)
-		fragColor.bgra = objColor * vec4(directLight(), 1.f);
-	else if (Mode == 2)
-		fragColor.brga = vec4(vec3(1.f) * castShadowCone(), 1.f);
-	else if (Mode == 3)
-		fragColor.bgra = objColor * 1.5f * vec4(indirectDiffuseLight(), 1.f);
-	else if (Mode == 4)
-		fragColor.bgra = objColor * vec4(indirectSpecularLight(), 1.f) * 3.f;
-	else if (Mode == 5)
-		fragColor.bgra = objColor * vec4(0.7f * (indirectSpecularLight() + indirectDiffuseLight() + directLight()*castShadowCone()) + 0.8f * material.emissivity * material.diffuse, 1.f);
-		
-}
\ No newline at end of file
+#endif
+	initSurface();
+
+#ifdef INDIRECT_DIFFUSE_PASS
+	fragColor = vec4(indirectDiffuseIrradiance(), 1.f);
+	diffuseSurface = vec4(fragNormNorm, distance(fragPos, view_pos));
+	diffuseMotion = vec4(0.5f * (currentClipPos.xy / currentClipPos.w - previousClipPos.xy / previousClipPos.w),
+		previousClipPos.w, currentClipPos.w);
+#elif defined(AMBIENT_OCCLUSION_PASS)
+	fragColor = vec4(ambientOcclusion());
+	occlusionSurface = vec4(fragNormNorm, distance(fragPos, view_pos));
+#else
+#if AMBIENT_OCCLUSION
+	ambientVisibility = upsampleAmbientOcclusion();
+#endif
+#if VIEW == 0
+	fragColor.bgra = sampleGrid(fragVoxelPos, 0.f);
+#elif VIEW == 1
+	fragColor.bgra = objColor * vec4(directLight(), 1.f);
+#elif VIEW == 2
+	fragColor.brga = vec4(vec3(1.f) * castShadowCone(), 1.f);
+#elif VIEW == 3
+	fragColor.bgra = objColor * 1.5f * vec4(indirectDiffuseLight(), 1.f);
+#elif VIEW == 4
+	fragColor.bgra = objColor * vec4(indirectSpecularLight(), 1.f) * 3.f;
+#elif VIEW == 6
+	fragColor = vec4(vec3(ambientVisibility), 1.f);
+#else
+	vec3 lighting = indirectDiffuseLight();
+#if SPECULAR
+	lighting += indirectSpecularLight();
+#endif
+#if SHADOWS
+	lighting += directLight() * castShadowCone();
+#else
+	lighting += directLight();
+#endif
+	fragColor.bgra = objColor * vec4(0.7f * lighting + 0.8f * material.emissivity * material.diffuse, 1.f);
+#endif
+#endif
+
+#ifdef STEP_HEATMAP
+	// Added rather than stored, overdraw on the forward path is part of the cost of a pixel
+	const ivec2 heatmapPixel = ivec2(gl_FragCoord.xy);
+	for (int type = 0; type < 3; ++type)
+		imageAtomicAdd(stepCounts, ivec3(heatmapPixel, type), pixelSteps[type]);
+	imageAtomicAdd(stepCounts, ivec3(heatmapPixel, 3), voxelFetches);
+#endif
+}
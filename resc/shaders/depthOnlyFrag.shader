@@ -0,0 +1,6 @@
+#version 450 core
+
+// Depth is all the pre-pass writes
+void main()
+{
+}
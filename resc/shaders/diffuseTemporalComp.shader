@@ -0,0 +1,99 @@
+#version 450 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// Irradiance, surface (normal, distance to the camera) and motion (screen position change, previous and current linear depth) of this frame
+layout(rgba16f, binding = 0) uniform readonly image2D currentIrradiance;
+layout(rgba32f, binding = 1) uniform readonly image2D currentSurface;
+layout(rgba32f, binding = 2) uniform readonly image2D currentMotion;
+
+// Accumulated irradiance with the history length in alpha, and normal with linear depth of the frame it was written in
+layout(rgba16f, binding = 3) uniform readonly image2D historyIrradiance;
+layout(rgba32f, binding = 4) uniform readonly image2D historySurface;
+layout(rgba16f, binding = 5) uniform writeonly image2D targetIrradiance;
+layout(rgba32f, binding = 6) uniform writeonly image2D targetSurface;
+
+uniform bool hasHistory;
+uniform float minBlend;
+
+// Longest history kept, the moving average takes over from the plain average before it
+const float MAX_HISTORY = 64.f;
+
+void main()
+{
+	const ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+	const ivec2 size = imageSize(currentIrradiance);
+	if (any(greaterThanEqual(pixel, size)))
+		return;
+
+	const vec4 surface = imageLoad(currentSurface, pixel);
+	const vec4 motion = imageLoad(currentMotion, pixel);
+	if (surface.w == 0.f)
+	{
+		imageStore(targetIrradiance, pixel, vec4(0.f));
+		imageStore(targetSurface, pixel, vec4(0.f));
+		return;
+	}
+
+	// Mean and deviation of the covered 3x3 neighbourhood bound how far the history may stray
+	const vec3 current = imageLoad(currentIrradiance, pixel).rgb;
+	vec3 mean = vec3(0.f);
+	vec3 meanSquared = vec3(0.f);
+	float count = 0.f;
+	for (int y = -1; y <= 1; ++y)
+	{
+		for (int x = -1; x <= 1; ++x)
+		{
+			const ivec2 neighbour = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+			if (imageLoad(currentSurface, neighbour).w == 0.f)
+				continue;
+
+			const vec3 value = imageLoad(currentIrradiance, neighbour).rgb;
+			mean += value;
+			meanSquared += value * value;
+			count += 1.f;
+		}
+	}
+	mean /= count;
+	const vec3 deviation = sqrt(max(meanSquared / count - mean * mean, vec3(0.f)));
+
+	// Bilinear fetch of the history where the surface was, taps on another surface are disoccluded
+	vec4 history = vec4(0.f);
+	float weightSum = 0.f;
+	if (hasHistory)
+	{
+		const vec2 previousPos = (vec2(pixel) + 0.5f) - motion.xy * vec2(size) - 0.5f;
+		const ivec2 base = ivec2(floor(previousPos));
+		const vec2 f = previousPos - vec2(base);
+		for (int y = 0; y < 2; ++y)
+		{
+			for (int x = 0; x < 2; ++x)
+			{
+				const ivec2 texel = base + ivec2(x, y);
+				if (any(lessThan(texel, ivec2(0))) || any(greaterThanEqual(texel, size)))
+					continue;
+
+				const vec4 previousSurface = imageLoad(historySurface, texel);
+				if (previousSurface.w == 0.f || abs(previousSurface.w - motion.z) > 0.05f * motion.z
+					|| dot(previousSurface.xyz, surface.xyz) < 0.8f)
+					continue;
+
+				const float weight = (x == 1 ? f.x : 1.f - f.x) * (y == 1 ? f.y : 1.f - f.y);
+				history += weight * imageLoad(historyIrradiance, texel);
+				weightSum += weight;
+			}
+		}
+	}
+
+	vec4 result = vec4(current, 1.f);
+	if (weightSum > 0.01f)
+	{
+		history /= weightSum;
+		const vec3 clamped = clamp(history.rgb, mean - 1.5f * deviation, mean + 1.5f * deviation);
+		const float historyLength = min(history.a + 1.f, MAX_HISTORY);
+		result = vec4(mix(clamped, current, max(1.f / historyLength, minBlend)), historyLength);
+	}
+
+	imageStore(targetIrradiance, pixel, result);
+	imageStore(targetSurface, pixel, vec4(surface.xyz, motion.w));
+}
@@ -0,0 +1,59 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+// One jump flooding pass, every cell takes the nearest seed among its 26 neighbours stepSize cells away
+layout(r32ui, binding = 0) uniform readonly uimage3D source;
+layout(r32ui, binding = 1) uniform writeonly uimage3D target;
+
+uniform int stepSize;
+
+const uint NO_SEED = 0xFFFFFFFFu;
+
+ivec3 unpackCell(uint value)
+{
+	return ivec3(value & 0x3FFu, (value >> 10) & 0x3FFu, (value >> 20) & 0x3FFu);
+}
+
+int squaredDistance(ivec3 a, ivec3 b)
+{
+	const ivec3 d = a - b;
+	return d.x * d.x + d.y * d.y + d.z * d.z;
+}
+
+void main()
+{
+	const ivec3 cell = ivec3(gl_GlobalInvocationID);
+	const ivec3 size = imageSize(source);
+	if (any(greaterThanEqual(cell, size)))
+		return;
+
+	uint best = imageLoad(source, cell).r;
+	int bestDistance = best == NO_SEED ? 0x7FFFFFFF : squaredDistance(cell, unpackCell(best));
+
+	for (int z = -1; z <= 1; ++z)
+	{
+		for (int y = -1; y <= 1; ++y)
+		{
+			for (int x = -1; x <= 1; ++x)
+			{
+				const ivec3 neighbour = cell + stepSize * ivec3(x, y, z);
+				if (any(lessThan(neighbour, ivec3(0))) || any(greaterThanEqual(neighbour, size)))
+					continue;
+
+				const uint seed = imageLoad(source, neighbour).r;
+				if (seed == NO_SEED)
+					continue;
+
+				const int distance = squaredDistance(cell, unpackCell(seed));
+				if (distance < bestDistance)
+				{
+					best = seed;
+					bestDistance = distance;
+				}
+			}
+		}
+	}
+
+	imageStore(target, cell, uvec4(best));
+}
@@ -0,0 +1,30 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+// Nearest seed of every cell after jump flooding
+layout(r32ui, binding = 0) uniform readonly uimage3D seeds;
+
+// Distance in cells to the nearest cell with geometry
+layout(r16f, binding = 1) uniform writeonly image3D distance;
+
+// Written when the grid holds no geometry at all
+uniform float noGeometry;
+
+const uint NO_SEED = 0xFFFFFFFFu;
+
+ivec3 unpackCell(uint value)
+{
+	return ivec3(value & 0x3FFu, (value >> 10) & 0x3FFu, (value >> 20) & 0x3FFu);
+}
+
+void main()
+{
+	const ivec3 cell = ivec3(gl_GlobalInvocationID);
+	if (any(greaterThanEqual(cell, imageSize(seeds))))
+		return;
+
+	const uint seed = imageLoad(seeds, cell).r;
+	const float cells = seed == NO_SEED ? noGeometry : length(vec3(cell - unpackCell(seed)));
+	imageStore(distance, cell, vec4(cells));
+}
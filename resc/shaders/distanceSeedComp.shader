@@ -0,0 +1,43 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+// Geometry volume, coverage in alpha
+uniform sampler3D geometry;
+
+// Voxels per cell edge
+uniform int cellSize;
+
+// Packed coordinates of the nearest seed cell, a cell with geometry is its own seed
+layout(r32ui, binding = 0) uniform writeonly uimage3D seeds;
+
+const uint NO_SEED = 0xFFFFFFFFu;
+
+uint packCell(ivec3 cell)
+{
+	return uint(cell.x) | (uint(cell.y) << 10) | (uint(cell.z) << 20);
+}
+
+void main()
+{
+	const ivec3 cell = ivec3(gl_GlobalInvocationID);
+	if (any(greaterThanEqual(cell, imageSize(seeds))))
+		return;
+
+	const ivec3 gridSize = textureSize(geometry, 0);
+	bool occupied = false;
+	for (int z = 0; z < cellSize; ++z)
+	{
+		for (int y = 0; y < cellSize; ++y)
+		{
+			for (int x = 0; x < cellSize; ++x)
+			{
+				const ivec3 voxel = cell * cellSize + ivec3(x, y, z);
+				if (all(lessThan(voxel, gridSize)) && texelFetch(geometry, voxel, 0).a > 0.f)
+					occupied = true;
+			}
+		}
+	}
+
+	imageStore(seeds, cell, uvec4(occupied ? packCell(cell) : NO_SEED));
+}
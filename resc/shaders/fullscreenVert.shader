@@ -0,0 +1,8 @@
+#version 450 core
+
+// One triangle covering the screen, drawn without vertex attributes
+void main()
+{
+	const vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(2.f * corner - vec2(1.f), 0.f, 1.f);
+}
@@ -0,0 +1,21 @@
+#version 450 core
+
+in vec3 fragNorm;
+in vec3 fragPos;
+in vec2 texCoords;
+
+layout(location = 0) out vec4 gPosition;
+layout(location = 1) out vec4 gNormal;
+layout(location = 2) out vec4 gColor;
+
+uniform sampler2D texUnit;
+
+// Index into the material table of the deferred cone tracing pass
+uniform int materialIndex;
+
+void main()
+{
+	gPosition = vec4(fragPos, float(materialIndex));
+	gNormal = vec4(normalize(fragNorm), 1.f);
+	gColor = texture(texUnit, texCoords);
+}
@@ -0,0 +1,152 @@
+#version 450 core
+
+// Lights every voxel of a region, or with SHADOW_MAP_INJECTION only the voxels a cube shadow map texel sees
+#ifdef SHADOW_MAP_INJECTION
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+#else
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+#endif
+
+struct Light
+{
+	vec3 position;
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	float constant;
+	float linear;
+	float quadratic;
+};
+
+uniform Light light;
+
+// Geometry volumes from voxelization, alpha holds coverage
+uniform sampler3D voxAlbedo;
+uniform sampler3D voxNormal;
+uniform sampler3D voxEmissive;
+// Texture colour times the material's ambient factor
+uniform sampler3D voxAmbient;
+
+// Indirect light reflected by each voxel, gathered by the bounce pass of the previous frames
+uniform sampler3D voxBounce;
+uniform bool multiBounce;
+
+#ifndef VOXEL_FORMAT
+#define VOXEL_FORMAT rgba8
+#endif
+
+layout(VOXEL_FORMAT, binding = 0) writeonly uniform image3D voxRadiance;
+#ifdef VOXEL_OPACITY_VOLUME
+// Coverage for formats without alpha
+layout(r8, binding = 1) writeonly uniform image3D voxOpacity;
+#endif
+
+#ifdef SHADOW_MAP_INJECTION
+// World positions of the surfaces the light sees, alpha 0 where nothing was hit
+layout(rgba32f, binding = 2) readonly uniform imageCube shadowPositions;
+
+// World space to 0->1 coordinates of the voxel volume
+uniform mat4 worldToVoxel;
+#endif
+
+// Without a shadow map every voxel facing the light is lit, with one only the voxels it sees
+uniform bool directLight;
+
+// 0->1 coordinates of the voxel volume to world space
+uniform mat4 voxelToWorld;
+
+// Region of the volume to relight
+uniform ivec3 regionOffset;
+uniform ivec3 regionSize;
+
+float calculateAttenuation(float dist)
+{
+	return 1.0f / (light.constant + light.linear * dist + light.quadratic * pow(dist, 2));
+}
+
+// Radiance leaving an occupied voxel, the diffuse term only if it is lit
+vec3 shadeVoxel(ivec3 pos, vec3 albedo, bool lit)
+{
+	const ivec3 dim = imageSize(voxRadiance);
+	const vec3 normal = normalize(2.f * texelFetch(voxNormal, pos, 0).xyz - vec3(1.f));
+	const vec3 emissive = texelFetch(voxEmissive, pos, 0).rgb;
+	const vec3 ambient = texelFetch(voxAmbient, pos, 0).rgb;
+
+	// Voxel centre in world space
+	const vec3 worldPos = (voxelToWorld * vec4((vec3(pos) + vec3(0.5f)) / vec3(dim), 1.f)).xyz;
+
+	// View independent part of the Phong model, specular is left to the cone tracer
+	const vec3 lightDir = normalize(light.position - worldPos);
+	const float diff = lit ? max(dot(normal, lightDir), 0.f) : 0.f;
+	const float attenuation = calculateAttenuation(length(light.position - worldPos));
+
+	vec3 radiance = attenuation * (ambient * light.ambient + albedo * light.diffuse * diff) + emissive;
+	if (multiBounce)
+		radiance += texelFetch(voxBounce, pos, 0).rgb;
+	return radiance;
+}
+
+void storeRadiance(ivec3 pos, vec3 radiance, float coverage)
+{
+#ifdef VOXEL_HDR
+	imageStore(voxRadiance, pos, vec4(radiance, coverage));
+#else
+	imageStore(voxRadiance, pos, vec4(min(radiance, vec3(1.f)), coverage));
+#endif
+}
+
+#ifdef SHADOW_MAP_INJECTION
+void main()
+{
+	const ivec3 texel = ivec3(gl_GlobalInvocationID);
+	if (any(greaterThanEqual(texel.xy, imageSize(shadowPositions))))
+		return;
+
+	const vec4 surface = imageLoad(shadowPositions, texel);
+	if (surface.a == 0.f)
+		return;
+
+	// The surface lies on the boundary of its voxel, half a voxel towards the light finds it when it rounds outside
+	const ivec3 dim = imageSize(voxRadiance);
+	const vec3 voxelPos = vec3(dim) * (worldToVoxel * vec4(surface.xyz, 1.f)).xyz;
+	const vec3 toLight = normalize(vec3(dim) * (worldToVoxel * vec4(light.position, 1.f)).xyz - voxelPos);
+	for (int attempt = 0; attempt < 2; ++attempt)
+	{
+		const ivec3 pos = ivec3(floor(voxelPos + 0.5f * float(attempt) * toLight)) - regionOffset;
+		if (any(lessThan(pos, ivec3(0))) || any(greaterThanEqual(pos, regionSize)))
+			return;
+
+		const ivec3 voxel = regionOffset + pos;
+		const vec4 albedo = texelFetch(voxAlbedo, voxel, 0);
+		if (albedo.a > 0.f)
+		{
+			// Every texel hitting this voxel stores the same value, no atomics are needed
+			storeRadiance(voxel, shadeVoxel(voxel, albedo.rgb, true), albedo.a);
+			return;
+		}
+	}
+}
+#else
+void main()
+{
+	if (any(greaterThanEqual(ivec3(gl_GlobalInvocationID), regionSize)))
+		return;
+
+	const ivec3 pos = regionOffset + ivec3(gl_GlobalInvocationID);
+
+	const vec4 albedo = texelFetch(voxAlbedo, pos, 0);
+	if (albedo.a == 0.f)
+	{
+		imageStore(voxRadiance, pos, vec4(0.f));
+#ifdef VOXEL_OPACITY_VOLUME
+		imageStore(voxOpacity, pos, vec4(0.f));
+#endif
+		return;
+	}
+
+	storeRadiance(pos, shadeVoxel(pos, albedo.rgb, directLight), albedo.a);
+#ifdef VOXEL_OPACITY_VOLUME
+	imageStore(voxOpacity, pos, vec4(albedo.a));
+#endif
+}
+#endif
@@ -0,0 +1,61 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+#ifndef VOXEL_FORMAT
+#define VOXEL_FORMAT rgba8
+#endif
+
+uniform sampler3D source;
+uniform int sourceLevel;
+
+// Source level holds straight colour with coverage in alpha
+uniform bool premultiply;
+
+// Region of the destination level to rebuild
+uniform ivec3 regionOffset;
+uniform ivec3 regionSize;
+
+layout(VOXEL_FORMAT, binding = 0) writeonly uniform image3D destination;
+
+#ifdef VOXEL_OPACITY_VOLUME
+// Coverage for formats without alpha
+uniform sampler3D opacitySource;
+layout(r8, binding = 2) writeonly uniform image3D opacityDestination;
+#endif
+
+vec4 fetchVoxel(ivec3 pos, int level)
+{
+#ifdef VOXEL_OPACITY_VOLUME
+	return vec4(texelFetch(source, pos, level).rgb, texelFetch(opacitySource, pos, level).r);
+#else
+	return texelFetch(source, pos, level);
+#endif
+}
+
+void main()
+{
+	if (any(greaterThanEqual(ivec3(gl_GlobalInvocationID), regionSize)))
+		return;
+
+	const ivec3 dst = regionOffset + ivec3(gl_GlobalInvocationID);
+	const ivec3 sourceSize = textureSize(source, sourceLevel);
+
+	vec4 acc = vec4(0.f);
+	for (int i = 0; i < 8; ++i)
+	{
+		const ivec3 src = 2 * dst + ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+		if (any(greaterThanEqual(src, sourceSize)))
+			continue;
+
+		vec4 voxel = fetchVoxel(src, sourceLevel);
+		if (premultiply)
+			voxel.rgb *= voxel.a;
+		acc += voxel;
+	}
+
+	imageStore(destination, dst, 0.125f * acc);
+#ifdef VOXEL_OPACITY_VOLUME
+	imageStore(opacityDestination, dst, vec4(0.125f * acc.a));
+#endif
+}
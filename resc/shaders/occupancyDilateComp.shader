@@ -0,0 +1,31 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+// Occupancy of each block of one level, and the same level with each block grown by its neighbours
+layout(r8, binding = 0) uniform readonly image3D blocks;
+layout(r8, binding = 1) uniform writeonly image3D occupancy;
+
+void main()
+{
+	const ivec3 block = ivec3(gl_GlobalInvocationID);
+	const ivec3 size = imageSize(blocks);
+	if (any(greaterThanEqual(block, size)))
+		return;
+
+	float occupied = 0.f;
+	for (int z = -1; z <= 1; ++z)
+	{
+		for (int y = -1; y <= 1; ++y)
+		{
+			for (int x = -1; x <= 1; ++x)
+			{
+				const ivec3 neighbour = block + ivec3(x, y, z);
+				if (all(greaterThanEqual(neighbour, ivec3(0))) && all(lessThan(neighbour, size)))
+					occupied = max(occupied, imageLoad(blocks, neighbour).r);
+			}
+		}
+	}
+
+	imageStore(occupancy, block, vec4(occupied));
+}
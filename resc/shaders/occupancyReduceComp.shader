@@ -0,0 +1,42 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+// Geometry volume, coverage in alpha, read for level 0
+uniform sampler3D geometry;
+
+// Level written, the level below is read from finer
+uniform int level;
+
+layout(r8, binding = 0) uniform readonly image3D finer;
+layout(r8, binding = 1) uniform writeonly image3D coarser;
+
+void main()
+{
+	const ivec3 block = ivec3(gl_GlobalInvocationID);
+	const ivec3 size = imageSize(coarser);
+	if (any(greaterThanEqual(block, size)))
+		return;
+
+	if (level == 0)
+	{
+		imageStore(coarser, block, vec4(texelFetch(geometry, block, 0).a > 0.f ? 1.f : 0.f));
+		return;
+	}
+
+	// Levels are rounded down, the last block of an odd axis also takes the remaining texel below
+	const ivec3 finerSize = imageSize(finer);
+	const ivec3 first = 2 * block;
+	const ivec3 last = mix(first + 1, finerSize - 1, equal(block, size - 1));
+	float occupied = 0.f;
+	for (int z = first.z; z <= last.z; ++z)
+	{
+		for (int y = first.y; y <= last.y; ++y)
+		{
+			for (int x = first.x; x <= last.x; ++x)
+				occupied = max(occupied, imageLoad(finer, ivec3(x, y, z)).r);
+		}
+	}
+
+	imageStore(coarser, block, vec4(occupied));
+}
@@ -0,0 +1,11 @@
+#version 450 core
+
+in vec3 worldPos;
+
+// Alpha marks texels where a surface was hit
+out vec4 position;
+
+void main()
+{
+	position = vec4(worldPos, 1.f);
+}
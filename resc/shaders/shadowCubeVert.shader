@@ -0,0 +1,14 @@
+#version 450 core
+
+layout(location = 0) in vec3 vertex_position;
+
+out vec3 worldPos;
+
+uniform mat4 model;
+uniform mat4 viewProj;
+
+void main()
+{
+	worldPos = vec3(model * vec4(vertex_position, 1.f));
+	gl_Position = viewProj * vec4(worldPos, 1.f);
+}
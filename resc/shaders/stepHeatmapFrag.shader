@@ -0,0 +1,36 @@
+#version 450 core
+
+// Per-pixel counts of the instrumented cone tracing pass: diffuse, specular and shadow steps, voxel fetches
+layout(r32ui, binding = 6) readonly uniform uimage2DArray counts;
+
+// Layer to show, or 4 for the steps of all cone types
+uniform int quantity;
+// Reciprocal of the count shown at full intensity
+uniform float scale;
+
+out vec4 fragColor;
+
+// Blue through green and yellow to red, white above the scale
+vec3 heat(float t)
+{
+	if (t > 1.f)
+		return vec3(1.f);
+	return clamp(vec3(2.f * t - 0.5f, 2.f - abs(4.f * t - 2.f), 1.f - 2.f * t), 0.f, 1.f);
+}
+
+void main()
+{
+	const ivec2 pixel = ivec2(gl_FragCoord.xy);
+	uint count = 0u;
+	if (quantity == 4)
+	{
+		for (int layer = 0; layer < 3; ++layer)
+			count += imageLoad(counts, ivec3(pixel, layer)).r;
+	}
+	else
+	{
+		count = imageLoad(counts, ivec3(pixel, quantity)).r;
+	}
+
+	fragColor = count == 0u ? vec4(0.f, 0.f, 0.f, 1.f) : vec4(heat(float(count) * scale), 1.f);
+}
@@ -0,0 +1,187 @@
+#version 450 core
+
+// One invocation per triangle of the model bound as shader storage buffers
+layout(local_size_x = 64) in;
+
+struct Material
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	float shininess;
+	float emissivity;
+	float diffuseReflectivity;
+	float specularReflectivity;
+};
+
+layout(std430, binding = 0) readonly buffer Positions { float positions[]; };
+layout(std430, binding = 1) readonly buffer Normals { float normals[]; };
+layout(std430, binding = 2) readonly buffer TexCoords { float texCoords[]; };
+layout(std430, binding = 3) readonly buffer Indices { uint indices[]; };
+
+// Triangles too large for the loop below, drawn indirectly by the raster path
+layout(std430, binding = 4) writeonly buffer LargeTriangles { uint largeIndices[]; };
+layout(std430, binding = 5) buffer DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+} command;
+
+uniform int triangleCount;
+
+// Largest voxel space bounding box extent along any axis handled here
+uniform float sizeThreshold;
+
+uniform mat4 model;
+uniform bool hasTexCoords;
+uniform Material material;
+uniform sampler2D texUnit;
+
+// World space to 0->1 coordinates of the voxel volume
+uniform mat4 worldToVoxel;
+uniform ivec3 gridDims;
+
+// Geometry volumes, alpha holds coverage
+const int ALBEDO = 0;
+const int NORMAL = 1;
+const int EMISSIVE = 2;
+const int AMBIENT = 3;
+layout(rgba8, binding = 0) uniform image3D voxGeometry[4];
+
+// Same textures viewed as packed RGBA8 for atomic averaging
+layout(r32ui, binding = 4) coherent volatile uniform uimage3D voxGeometryAtomic[4];
+
+// Atomic writes given up after too many contended retries, reported by CornellScene
+layout(std430, binding = 6) buffer AtomicDrops { uint droppedWrites; };
+
+uniform bool atomicAverage;
+
+// Voxel layers [x, y) along z being re-voxelized
+uniform ivec2 slabRange;
+
+vec3 fetchVec3(uint index, bool normal)
+{
+	return normal ? vec3(normals[3 * index], normals[3 * index + 1], normals[3 * index + 2])
+		: vec3(positions[3 * index], positions[3 * index + 1], positions[3 * index + 2]);
+}
+
+vec4 unpackRGBA8(uint value)
+{
+	return vec4(float(value & 0xFFu), float((value >> 8) & 0xFFu), float((value >> 16) & 0xFFu), float((value >> 24) & 0xFFu));
+}
+
+uint packRGBA8(vec4 value)
+{
+	const uvec4 v = uvec4(round(clamp(value, 0.f, 255.f)));
+	return (v.a << 24) | (v.b << 16) | (v.g << 8) | v.r;
+}
+
+// Same running average as voxelizationFrag.shader, one sample per voxel a triangle touches
+void imageAtomicAverage(int volume, ivec3 coords, vec3 value)
+{
+	const vec4 incoming = vec4(255.f * value, 1.f);
+
+	uint newValue = packRGBA8(incoming);
+	uint expected = 0u;
+	uint stored;
+	bool written = false;
+
+	for (int i = 0; i < 255; ++i)
+	{
+		stored = imageAtomicCompSwap(voxGeometryAtomic[volume], coords, expected, newValue);
+		if (stored == expected)
+		{
+			written = true;
+			break;
+		}
+
+		expected = stored;
+		vec4 average = unpackRGBA8(stored);
+		// Past 255 fragments the count saturates and the average turns into a moving average with that weight
+		const float count = min(average.a + 1.f, 255.f);
+		average.rgb = (average.rgb * (count - 1.f) + incoming.rgb) / count;
+		average.a = count;
+		newValue = packRGBA8(average);
+	}
+	if (!written)
+		atomicAdd(droppedWrites, 1u);
+}
+
+void writeVoxel(int volume, ivec3 coords, vec3 value)
+{
+	if (atomicAverage)
+		imageAtomicAverage(volume, coords, value);
+	else
+		imageStore(voxGeometry[volume], coords, vec4(value, 1.f));
+}
+
+void main()
+{
+	const uint triangle = gl_GlobalInvocationID.x;
+	if (triangle >= uint(triangleCount))
+		return;
+
+	uint index[3];
+	vec3 vox[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		index[i] = indices[3 * triangle + i];
+		const vec3 worldPos = vec3(model * vec4(fetchVec3(index[i], false), 1.f));
+		vox[i] = vec3(gridDims) * (worldToVoxel * vec4(worldPos, 1.f)).xyz;
+	}
+
+	const vec3 boxMin = min(vox[0], min(vox[1], vox[2]));
+	const vec3 boxMax = max(vox[0], max(vox[1], vox[2]));
+	if (any(greaterThan(boxMax - boxMin, vec3(sizeThreshold))))
+	{
+		const uint slot = atomicAdd(command.count, 3u);
+		for (int i = 0; i < 3; ++i)
+			largeIndices[slot + i] = index[i];
+		return;
+	}
+
+	// The triangle spans a few voxels at most, its centroid stands in for every fragment
+	vec3 normal = vec3(0.f);
+	vec2 uv = vec2(0.f);
+	for (int i = 0; i < 3; ++i)
+	{
+		normal += fetchVec3(index[i], true);
+		if (hasTexCoords)
+			uv += vec2(texCoords[2 * index[i]], texCoords[2 * index[i] + 1]) / 3.f;
+	}
+	normal = mat3(transpose(inverse(model))) * normal;
+
+	const vec4 objColor = textureLod(texUnit, uv, 0.f);
+	const vec3 albedo = min(objColor.rgb * material.diffuse, vec3(1.f));
+	const vec3 emissive = min(objColor.rgb * material.emissivity * material.diffuse, vec3(1.f));
+	const vec3 ambient = min(objColor.rgb * material.ambient, vec3(1.f));
+	const vec3 packedNormal = 0.5f * normalize(normal) + vec3(0.5f);
+
+	// Voxels of the bounding box the triangle plane passes through, as conservative rasterization would produce
+	const vec3 planeNormal = cross(vox[1] - vox[0], vox[2] - vox[0]);
+	const float planeDistance = dot(planeNormal, vox[0]);
+	const float radius = 0.5f * dot(abs(planeNormal), vec3(1.f));
+
+	const ivec3 first = max(ivec3(floor(boxMin)), ivec3(0, 0, slabRange.x));
+	const ivec3 last = min(ivec3(floor(boxMax)), ivec3(gridDims.xy - 1, slabRange.y - 1));
+	for (int z = first.z; z <= last.z; ++z)
+	{
+		for (int y = first.y; y <= last.y; ++y)
+		{
+			for (int x = first.x; x <= last.x; ++x)
+			{
+				const ivec3 coords = ivec3(x, y, z);
+				if (abs(dot(planeNormal, vec3(coords) + vec3(0.5f)) - planeDistance) > radius)
+					continue;
+
+				writeVoxel(ALBEDO, coords, albedo);
+				writeVoxel(NORMAL, coords, packedNormal);
+				writeVoxel(EMISSIVE, coords, emissive);
+				writeVoxel(AMBIENT, coords, ambient);
+			}
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+// Geometry volumes from voxelization, alpha holds coverage
+uniform sampler3D voxAlbedo;
+uniform sampler3D voxNormal;
+
+// Lit voxel grid and its directional volumes, as sampled by the cone tracer
+uniform sampler3D voxGrid;
+uniform sampler3D voxAniso[6]; // +X, -X, +Y, -Y, +Z, -Z at half the grid resolution
+#ifdef VOXEL_OPACITY_VOLUME
+uniform sampler3D voxOpacity;
+uniform sampler3D voxAnisoOpacity[6];
+#endif
+uniform bool anisotropic;
+
+// Diffusely reflected indirect light of every voxel, added to the radiance at the next light injection
+layout(r11f_g11f_b10f, binding = 0) writeonly uniform image3D voxBounce;
+
+// Only voxels whose position in their 2x2x2 block is congruent to phase modulo phaseCount are updated
+uniform int phase;
+uniform int phaseCount;
+
+// Six cones of 60 degrees aperture covering the hemisphere around +Z, weighted by their cosine lobe share
+const int CONE_COUNT = 6;
+const vec3 coneDirections[CONE_COUNT] = vec3[](
+	vec3(0.f, 0.f, 1.f),
+	vec3(0.f, 0.866025f, 0.5f),
+	vec3(0.823639f, 0.267617f, 0.5f),
+	vec3(0.509037f, -0.700629f, 0.5f),
+	vec3(-0.509037f, -0.700629f, 0.5f),
+	vec3(-0.823639f, 0.267617f, 0.5f));
+const float coneWeights[CONE_COUNT] = float[](0.25f, 0.15f, 0.15f, 0.15f, 0.15f, 0.15f);
+const float coneTan = 0.577350f;
+
+vec4 sampleGrid(vec3 pos, float lod)
+{
+#ifdef VOXEL_OPACITY_VOLUME
+	return vec4(textureLod(voxGrid, pos, lod).rgb, textureLod(voxOpacity, pos, lod).r);
+#else
+	return textureLod(voxGrid, pos, lod);
+#endif
+}
+
+vec4 sampleDirection(int dir, vec3 pos, float lod)
+{
+#ifdef VOXEL_OPACITY_VOLUME
+	return vec4(textureLod(voxAniso[dir], pos, lod).rgb, textureLod(voxAnisoOpacity[dir], pos, lod).r);
+#else
+	return textureLod(voxAniso[dir], pos, lod);
+#endif
+}
+
+vec4 sampleAnisotropic(vec3 pos, vec3 dir, float lod)
+{
+	const vec3 weight = dir * dir;
+	const vec4 x = dir.x > 0.f ? sampleDirection(0, pos, lod) : sampleDirection(1, pos, lod);
+	const vec4 y = dir.y > 0.f ? sampleDirection(2, pos, lod) : sampleDirection(3, pos, lod);
+	const vec4 z = dir.z > 0.f ? sampleDirection(4, pos, lod) : sampleDirection(5, pos, lod);
+	return weight.x * x + weight.y * y + weight.z * z;
+}
+
+// Same level selection as coneTracingFrag.shader
+vec4 sampleVoxels(vec3 pos, vec3 dir, float lod)
+{
+	if (!anisotropic)
+		return sampleGrid(pos, lod);
+
+	if (lod < 1.f)
+		return mix(sampleGrid(pos, 0.f), sampleAnisotropic(pos, dir, 0.f), lod);
+	return sampleAnisotropic(pos, dir, lod - 1.f);
+}
+
+// Radiance arriving along a cone, marched in voxel units from a point just off the surface
+vec3 traceCone(vec3 from, vec3 dir, vec3 dims, float maxLod)
+{
+	vec4 acc = vec4(0.f);
+	float dist = 1.f;
+	while (acc.a < 0.95f)
+	{
+		const vec3 pos = from + dist * dir;
+		if (any(lessThan(pos, vec3(0.f))) || any(greaterThanEqual(pos, dims)))
+			break;
+
+		const float diameter = max(2.f * coneTan * dist, 1.f);
+		const vec4 voxel = sampleVoxels(pos / dims, dir, min(log2(diameter), maxLod));
+
+		// Samples above level 0 hold premultiplied colour, level 0 coverage is 0 or 1
+		acc.rgb += (1.f - acc.a) * voxel.rgb;
+		acc.a += (1.f - acc.a) * voxel.a;
+		dist += 0.5f * diameter;
+	}
+	return acc.rgb;
+}
+
+void main()
+{
+	const ivec3 pos = ivec3(gl_GlobalInvocationID);
+	const ivec3 dim = imageSize(voxBounce);
+	if (any(greaterThanEqual(pos, dim)))
+		return;
+
+	const int blockIndex = (pos.x & 1) | ((pos.y & 1) << 1) | ((pos.z & 1) << 2);
+	if (blockIndex % phaseCount != phase)
+		return;
+
+	const vec4 albedo = texelFetch(voxAlbedo, pos, 0);
+	if (albedo.a == 0.f)
+	{
+		imageStore(voxBounce, pos, vec4(0.f));
+		return;
+	}
+
+	const vec3 normal = normalize(2.f * texelFetch(voxNormal, pos, 0).xyz - vec3(1.f));
+	const vec3 tangent = normalize(cross(normal, abs(normal.y) < 0.99f ? vec3(0.f, 1.f, 0.f) : vec3(1.f, 0.f, 0.f)));
+	const vec3 bitangent = cross(normal, tangent);
+
+	// Start a voxel off the surface so the cones do not see the voxel itself
+	const vec3 from = vec3(pos) + vec3(0.5f) + normal;
+	const float maxLod = float(textureQueryLevels(voxGrid) - 1);
+
+	vec3 irradiance = vec3(0.f);
+	for (int i = 0; i < CONE_COUNT; ++i)
+	{
+		const vec3 dir = normalize(coneDirections[i].x * tangent + coneDirections[i].y * bitangent + coneDirections[i].z * normal);
+		irradiance += coneWeights[i] * traceCone(from, dir, vec3(dim), maxLod);
+	}
+
+	imageStore(voxBounce, pos, vec4(albedo.rgb * irradiance, 1.f));
+}
@@ -0,0 +1,21 @@
+#version 450 core
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+// Geometry volumes written by atomic averaging, with the fragment count in alpha
+layout(rgba8, binding = 0) uniform image3D voxGeometry[4];
+
+void main()
+{
+	const ivec3 pos = ivec3(gl_GlobalInvocationID);
+	if (any(greaterThanEqual(pos, imageSize(voxGeometry[0]))))
+		return;
+
+	// Any fragment count means a fully covered voxel
+	for (int i = 0; i < 4; ++i)
+	{
+		const vec4 voxel = imageLoad(voxGeometry[i], pos);
+		if (voxel.a > 0.f)
+			imageStore(voxGeometry[i], pos, vec4(voxel.rgb, 1.f));
+	}
+}
@@ -11,64 +11,104 @@ struct Material
 	float specularReflectivity;
 };
 
-struct Light
-{
-	vec3 position;
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-	float constant;
-	float linear;
-	float quadratic;
-};
-
 in vec3 fragNormal;
 in vec3 fragPos;
 in vec2 fragTexCoords;
 
-uniform vec3 view_pos;
-
 uniform Material material;
-uniform Light light;
 
 uniform sampler2D texUnit;
-layout(RGBA8) uniform image3D voxGrid;
 
-float calculateAttenuation(float dist, Light light)
+// Geometry volumes, alpha holds coverage
+const int ALBEDO = 0;
+const int NORMAL = 1;
+const int EMISSIVE = 2;
+const int AMBIENT = 3;
+layout(rgba8, binding = 0) uniform image3D voxGeometry[4];
+
+// Same textures viewed as packed RGBA8 for atomic averaging
+layout(r32ui, binding = 4) coherent volatile uniform uimage3D voxGeometryAtomic[4];
+
+// Atomic writes given up after too many contended retries, reported by CornellScene
+layout(std430, binding = 6) buffer AtomicDrops { uint droppedWrites; };
+
+uniform bool atomicAverage;
+
+// Voxel layers [x, y) along z being re-voxelized
+uniform ivec2 slabRange;
+
+// World space to 0->1 coordinates of the voxel volume
+uniform mat4 worldToVoxel;
+
+vec4 unpackRGBA8(uint value)
 {
-	return 1.0f / (light.constant + light.linear * dist + light.quadratic * pow(dist, 2));
+	return vec4(float(value & 0xFFu), float((value >> 8) & 0xFFu), float((value >> 16) & 0xFFu), float((value >> 24) & 0xFFu));
 }
 
-void main()
+uint packRGBA8(vec4 value)
 {
-	// Ambient color calculation
-	vec3 ambient = light.ambient * material.ambient;
-
-	// Diffuse color calculation
-	vec3 normNorm = normalize( fragNormal );
-	vec3 light_dir = normalize( light.position - fragPos );
-	float diff = max( dot( normNorm, light_dir), 0.0 );
-	vec3 diffuse = light.diffuse * ( diff * material.diffuse );
-
-	// Specular light calculation
-	vec3 view_dir = normalize( view_pos - fragPos );
-	vec3 reflect_dir = reflect( -light_dir, normNorm );
-	float spec = pow( max( dot( view_dir, reflect_dir ), 0.0f), material.shininess );
-	vec3 specular = light.specular * (spec * material.specular);
-
-	// Texture coordinates and attenuation
-	vec4 objColor = texture(texUnit, fragTexCoords);
-	float attenuation = calculateAttenuation(length(light.position - fragPos), light);
+	const uvec4 v = uvec4(round(clamp(value, 0.f, 255.f)));
+	return (v.a << 24) | (v.b << 16) | (v.g << 8) | v.r;
+}
+
+// Running average of all fragments falling in a voxel. rgb holds the average, alpha the fragment count.
+void imageAtomicAverage(int volume, ivec3 coords, vec3 value)
+{
+	const vec4 incoming = vec4(255.f * value, 1.f);
+
+	uint newValue = packRGBA8(incoming);
+	uint expected = 0u;
+	uint stored;
+	bool written = false;
+
+	// Retry until no other fragment wrote between our read and our swap. Capped to not hang on a saturated voxel.
+	for (int i = 0; i < 255; ++i)
+	{
+		stored = imageAtomicCompSwap(voxGeometryAtomic[volume], coords, expected, newValue);
+		if (stored == expected)
+		{
+			written = true;
+			break;
+		}
+
+		expected = stored;
+		vec4 average = unpackRGBA8(stored);
+		// Past 255 fragments the count saturates and the average turns into a moving average with that weight
+		const float count = min(average.a + 1.f, 255.f);
+		average.rgb = (average.rgb * (count - 1.f) + incoming.rgb) / count;
+		average.a = count;
+		newValue = packRGBA8(average);
+	}
+	if (!written)
+		atomicAdd(droppedWrites, 1u);
+}
 
-	// Add them
-	vec4 result = objColor * vec4( attenuation * ( ambient + diffuse + specular ) + material.emissivity * material.diffuse, 1.f);
+void writeVoxel(int volume, ivec3 coords, vec3 value)
+{
+	if (atomicAverage)
+		imageAtomicAverage(volume, coords, value);
+	else
+		imageStore(voxGeometry[volume], coords, vec4(value, 1.f));
+}
 
-	result.r = min(result.r, 1.0f);
-	result.g = min(result.g, 1.0f);
-	result.b = min(result.b, 1.0f);
+void main()
+{
+	// Only view independent surface properties are stored, lighting is injected separately
+	vec4 objColor = texture(texUnit, fragTexCoords);
+	vec3 albedo = min(objColor.rgb * material.diffuse, vec3(1.f));
+	vec3 emissive = min(objColor.rgb * material.emissivity * material.diffuse, vec3(1.f));
+	vec3 ambient = min(objColor.rgb * material.ambient, vec3(1.f));
+	vec3 normal = 0.5f * normalize(fragNormal) + vec3(0.5f);
 
 	// Upload result to (correct) voxel in voxel grid
-	ivec3 dim = imageSize(voxGrid);
-	vec3 voxelPos = 0.5f * fragPos + vec3(0.5f); // Map from -1->1 to 0->1 in 3D
-	imageStore(voxGrid, ivec3(dim * voxelPos), result);
-}
\ No newline at end of file
+	ivec3 dim = imageSize(voxGeometry[ALBEDO]);
+	vec3 voxelPos = (worldToVoxel * vec4(fragPos, 1.f)).xyz;
+	ivec3 coords = ivec3(dim * voxelPos);
+	if (any(lessThan(voxelPos, vec3(0.f))) || coords.z < slabRange.x || coords.z >= slabRange.y)
+		return;
+
+	writeVoxel(ALBEDO, coords, albedo);
+	writeVoxel(NORMAL, coords, normal);
+	writeVoxel(EMISSIVE, coords, emissive);
+	writeVoxel(AMBIENT, coords, ambient);
+}
@@ -13,21 +13,77 @@ out vec3 fragPos;
 out vec3 fragNormal;
 out vec2 fragTexCoords;
 
+// World space to 0->1 coordinates of the voxel volume and back
+uniform mat4 worldToVoxel;
+uniform mat4 voxelToWorld;
+uniform ivec3 gridDims;
+
+// Project into viewport 0-2 sized after the projection axis instead of a square of the largest dimension
+uniform bool viewportArray;
+
+// Expand triangles by half a voxel when conservative rasterization is not available in hardware
+uniform bool dilate;
+
+// Expands a triangle given in pixels by half a pixel diagonal (GPU Gems 2, chapter 42)
+void dilateTriangle(inout vec2 p[3])
+{
+	const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+	if (area == 0.f)
+		return;
+
+	// Edge lines pushed outwards, interior is on the positive side for counter clockwise triangles
+	vec3 lines[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		lines[i] = cross(vec3(p[i], 1.f), vec3(p[(i + 1) % 3], 1.f));
+		lines[i].z += sign(area) * 0.5f * (abs(lines[i].x) + abs(lines[i].y));
+	}
+
+	// New corners where the moved edges meet
+	for (int i = 0; i < 3; ++i)
+	{
+		const vec3 corner = cross(lines[(i + 2) % 3], lines[i]);
+		p[i] = corner.xy / corner.z;
+	}
+}
+
 void main() {
-	//Find normal of primitive
-	const vec3 prNorm = abs(cross(geomPos[1] - geomPos[0], geomPos[2] - geomPos[0])); // abs(cross(ab,ac)).
-	for (uint i = 0; i < 3; ++i) 
+	// Work in voxel units so the dominant axis and the dilation are correct for non cubic grids
+	vec3 vox[3];
+	for (int i = 0; i < 3; ++i)
+		vox[i] = vec3(gridDims) * (worldToVoxel * vec4(geomPos[i], 1.f)).xyz;
+
+	// As we only project along one axis, we move all geometry to the plane with the components that covers the most fragments.
+	const vec3 normal = cross(vox[1] - vox[0], vox[2] - vox[0]);
+	const vec3 prNorm = abs(normal);
+	int axis = 1;
+	if (prNorm.z > prNorm.x && prNorm.z > prNorm.y)
+		axis = 2;
+	else if (prNorm.x > prNorm.y && prNorm.x > prNorm.z)
+		axis = 0;
+	const ivec2 plane = axis == 0 ? ivec2(1, 2) : (axis == 1 ? ivec2(0, 2) : ivec2(0, 1));
+
+	vec2 projected[3];
+	for (int i = 0; i < 3; ++i)
+		projected[i] = vec2(vox[i][plane.x], vox[i][plane.y]);
+	if (dilate)
+		dilateTriangle(projected);
+
+	const vec2 viewport = viewportArray ? vec2(gridDims[plane.x], gridDims[plane.y]) : vec2(max(gridDims.x, max(gridDims.y, gridDims.z)));
+	for (int i = 0; i < 3; ++i) 
 	{
-		// As we only project along one axis, we move all geometry to the xy plane with the components that covers the most fragments.
-		// Coords not used, only to invoke right amount of fragment shader calls
-		if (prNorm.z > prNorm.x && prNorm.z > prNorm.y)
-			gl_Position = vec4(geomPos[i].x, geomPos[i].y, 0, 1);
-		else if (prNorm.x > prNorm.y && prNorm.x > prNorm.z)
-			gl_Position = vec4(geomPos[i].y, geomPos[i].z, 0, 1);
-		else
-			gl_Position = vec4(geomPos[i].x, geomPos[i].z, 0, 1);
+		// Moved corners are put back on the plane of the triangle
+		vec3 corner = vox[i];
+		corner[plane.x] = projected[i].x;
+		corner[plane.y] = projected[i].y;
+		corner[axis] = (dot(normal, vox[0]) - normal[plane.x] * projected[i].x - normal[plane.y] * projected[i].y) / normal[axis];
+
+		gl_Position = vec4(2.f * projected[i] / viewport - vec2(1.f), 0, 1);
+		if (viewportArray)
+			gl_ViewportIndex = axis;
+
 		// Send actual used position
-		fragPos = geomPos[i];
+		fragPos = (voxelToWorld * vec4(corner / vec3(gridDims), 1.f)).xyz;
 		fragNormal = geomNormal[i];
 		fragTexCoords = geomTexCoords[i];
 		EmitVertex();
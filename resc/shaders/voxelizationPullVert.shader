@@ -0,0 +1,96 @@
+#version 450 core
+#extension GL_ARB_shader_viewport_layer_array : require
+
+// Vertex pulling: one invocation per index, the whole triangle is read from the model buffers
+layout(std430, binding = 0) readonly buffer Positions { float positions[]; };
+layout(std430, binding = 1) readonly buffer Normals { float normals[]; };
+layout(std430, binding = 2) readonly buffer TexCoords { float texCoords[]; };
+layout(std430, binding = 3) readonly buffer Indices { uint indices[]; };
+
+out vec3 fragPos;
+out vec3 fragNormal;
+out vec2 fragTexCoords;
+
+uniform mat4 model;
+uniform bool hasTexCoords;
+
+// World space to 0->1 coordinates of the voxel volume and back
+uniform mat4 worldToVoxel;
+uniform mat4 voxelToWorld;
+uniform ivec3 gridDims;
+
+// Expand triangles by half a voxel when conservative rasterization is not available in hardware
+uniform bool dilate;
+
+vec3 fetchVec3(uint index, bool normal)
+{
+	return normal ? vec3(normals[3 * index], normals[3 * index + 1], normals[3 * index + 2])
+		: vec3(positions[3 * index], positions[3 * index + 1], positions[3 * index + 2]);
+}
+
+// Expands a triangle given in pixels by half a pixel diagonal (GPU Gems 2, chapter 42)
+void dilateTriangle(inout vec2 p[3])
+{
+	const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+	if (area == 0.f)
+		return;
+
+	// Edge lines pushed outwards, interior is on the positive side for counter clockwise triangles
+	vec3 lines[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		lines[i] = cross(vec3(p[i], 1.f), vec3(p[(i + 1) % 3], 1.f));
+		lines[i].z += sign(area) * 0.5f * (abs(lines[i].x) + abs(lines[i].y));
+	}
+
+	// New corners where the moved edges meet
+	for (int i = 0; i < 3; ++i)
+	{
+		const vec3 corner = cross(lines[(i + 2) % 3], lines[i]);
+		p[i] = corner.xy / corner.z;
+	}
+}
+
+void main()
+{
+	const int corner = gl_VertexID % 3;
+	const int first = gl_VertexID - corner;
+
+	// Same projection as voxelizationGeom.shader with viewport arrays, in voxel units
+	vec3 vox[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		const vec3 worldPos = vec3(model * vec4(fetchVec3(indices[first + i], false), 1.f));
+		vox[i] = vec3(gridDims) * (worldToVoxel * vec4(worldPos, 1.f)).xyz;
+	}
+
+	const vec3 normal = cross(vox[1] - vox[0], vox[2] - vox[0]);
+	const vec3 prNorm = abs(normal);
+	int axis = 1;
+	if (prNorm.z > prNorm.x && prNorm.z > prNorm.y)
+		axis = 2;
+	else if (prNorm.x > prNorm.y && prNorm.x > prNorm.z)
+		axis = 0;
+	const ivec2 plane = axis == 0 ? ivec2(1, 2) : (axis == 1 ? ivec2(0, 2) : ivec2(0, 1));
+
+	vec2 projected[3];
+	for (int i = 0; i < 3; ++i)
+		projected[i] = vec2(vox[i][plane.x], vox[i][plane.y]);
+	if (dilate)
+		dilateTriangle(projected);
+
+	// Moved corner is put back on the plane of the triangle
+	vec3 pos = vox[corner];
+	pos[plane.x] = projected[corner].x;
+	pos[plane.y] = projected[corner].y;
+	pos[axis] = (dot(normal, vox[0]) - normal[plane.x] * pos[plane.x] - normal[plane.y] * pos[plane.y]) / normal[axis];
+
+	const vec2 viewport = vec2(gridDims[plane.x], gridDims[plane.y]);
+	gl_Position = vec4(2.f * projected[corner] / viewport - vec2(1.f), 0, 1);
+	gl_ViewportIndex = axis;
+
+	const uint index = indices[gl_VertexID];
+	fragPos = (voxelToWorld * vec4(pos / vec3(gridDims), 1.f)).xyz;
+	fragNormal = mat3(transpose(inverse(model))) * fetchVec3(index, true);
+	fragTexCoords = hasTexCoords ? vec2(texCoords[2 * index], texCoords[2 * index + 1]) : vec2(0.f);
+}